@@ -33,6 +33,13 @@ include(src/http/http.pri)
 include(src/idle/idle.pri)
 
 HEADERS += src/video.h \
+    src/videorecord.h \
+    src/videodetailscache.h \
+    src/subscriptionvideos.h \
+    src/pagetokencache.h \
+    src/streamurlcache.h \
+    src/playerdecipher.h \
+    src/fmturlmap.h \
     src/searchlineedit.h \
     src/spacer.h \
     src/constants.h \
@@ -95,8 +102,11 @@ HEADERS += src/video.h \
     src/snapshotsettings.h \
     src/snapshotpreview.h \
     src/datautils.h \
+    src/jsonreader.h \
+    src/jsonparsetask.h \
     src/yt3listparser.h \
     src/ytchannel.h \
+    src/ytchanneluploads.h \
     src/yt3.h \
     src/paginatedvideosource.h \
     src/searchwidget.h \
@@ -108,6 +118,13 @@ SOURCES += src/main.cpp \
     src/searchlineedit.cpp \
     src/spacer.cpp \
     src/video.cpp \
+    src/videorecord.cpp \
+    src/videodetailscache.cpp \
+    src/subscriptionvideos.cpp \
+    src/pagetokencache.cpp \
+    src/streamurlcache.cpp \
+    src/playerdecipher.cpp \
+    src/fmturlmap.cpp \
     src/videomimedata.cpp \
     src/updatechecker.cpp \
     src/searchparams.cpp \
@@ -166,8 +183,11 @@ SOURCES += src/main.cpp \
     src/snapshotsettings.cpp \
     src/snapshotpreview.cpp \
     src/datautils.cpp \
+    src/jsonreader.cpp \
+    src/jsonparsetask.cpp \
     src/yt3listparser.cpp \
     src/ytchannel.cpp \
+    src/ytchanneluploads.cpp \
     src/yt3.cpp \
     src/paginatedvideosource.cpp \
     src/exlineedit.cpp \
@@ -23,55 +23,102 @@ $END_LICENSE */
 #include "database.h"
 #include <QtSql>
 
+namespace {
+
+// Column order of the select in loadVideos()
+enum Column {
+    VideoIdColumn = 0,
+    PublishedColumn,
+    TitleColumn,
+    AuthorColumn,
+    UserIdColumn,
+    DescriptionColumn,
+    ThumbUrlColumn,
+    ViewsColumn,
+    DurationColumn,
+    RowIdColumn
+};
+
+/**
+  * The id is set directly: the stored url is not selected and webpage()
+  * derives it from the id, so no video id regex ever runs here.
+  */
+VideoRecord videoFromRow(const QSqlQuery &query) {
+    VideoRecord record;
+    record.setId(query.value(VideoIdColumn).toString());
+    record.setPublished(QDateTime::fromTime_t(query.value(PublishedColumn).toUInt()));
+    record.setTitle(query.value(TitleColumn).toString());
+    record.setChannelTitle(query.value(AuthorColumn).toString());
+    record.setChannelId(query.value(UserIdColumn).toString());
+    record.setDescription(query.value(DescriptionColumn).toString());
+    record.setThumbnailUrl(query.value(ThumbUrlColumn).toString());
+    record.setViewCount(query.value(ViewsColumn).toInt());
+    record.setDuration(query.value(DurationColumn).toInt());
+    return record;
+}
+
+}
+
 AggregateVideoSource::AggregateVideoSource(QObject *parent) :
     VideoSource(parent),
-    unwatched(false), hasMore(true) { }
+    unwatched(false), hasMore(true),
+    nextIndex(1), lastPublished(0), lastId(0) { }
 
 void AggregateVideoSource::loadVideos(int max, int startIndex) {
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
+    // Seek past the last row of the previous page instead of skipping
+    // startIndex rows, so later pages cost the same as the first one.
+    // Offsets are only used when pages are not requested in sequence.
+    const bool seek = startIndex > 1 && startIndex == nextIndex;
+
+    QSqlQuery query = Database::instance().cachedQuery(pageSql(unwatched, seek));
+    if (seek) {
+        query.bindValue(0, lastPublished);
+        query.bindValue(1, lastPublished);
+        query.bindValue(2, lastId);
+        query.bindValue(3, max);
+    } else {
+        query.bindValue(0, startIndex - 1);
+        query.bindValue(1, max);
+    }
+    bool success = query.exec();
+    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+    QVector<VideoRecord> videos;
+    videos.reserve(max);
+    while (query.next()) {
+        const VideoRecord video = videoFromRow(query);
+        lastPublished = video.published().toTime_t();
+        lastId = query.value(RowIdColumn).toInt();
+        videos << video;
+    }
+
+    nextIndex = startIndex + videos.size();
+    hasMore = videos.size() >= max;
+
+    emit gotVideos(videos);
+    emit finished(videos.size());
+}
+
+QString AggregateVideoSource::pageSql(bool unwatched, bool seek) {
     QString sql = "select v.video_id,"
             "v.published,"
             "v.title,"
             "v.author,"
             "v.user_id,"
             "v.description,"
-            "v.url,"
             "v.thumb_url,"
             "v.views,"
-            "v.duration";
+            "v.duration,"
+            "v.id";
     if (unwatched)
         sql += " from subscriptions_videos v, subscriptions s where v.channel_id=s.id "
-                "and v.added>s.watched and v.published>s.watched and v.watched=0 "
-                "order by v.published desc ";
+                "and v.added>s.watched and v.published>s.watched and v.watched=0 ";
     else
-        sql += " from subscriptions_videos v order by published desc ";
-    sql += "limit ?,?";
-    query.prepare(sql);
-    query.bindValue(0, startIndex - 1);
-    query.bindValue(1, max);
-    bool success = query.exec();
-    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
-    QList<Video*> videos;
-    while (query.next()) {
-        Video *video = new Video();
-        video->setId(query.value(0).toString());
-        video->setPublished(QDateTime::fromTime_t(query.value(1).toUInt()));
-        video->setTitle(query.value(2).toString());
-        video->setChannelTitle(query.value(3).toString());
-        video->setChannelId(query.value(4).toString());
-        video->setDescription(query.value(5).toString());
-        video->setWebpage(query.value(6).toString());
-        video->setThumbnailUrl(query.value(7).toString());
-        video->setViewCount(query.value(8).toInt());
-        video->setDuration(query.value(9).toInt());
-        videos << video;
-    }
-
-    hasMore = videos.size() >= max;
-
-    emit gotVideos(videos);
-    emit finished(videos.size());
+        sql += " from subscriptions_videos v where 1 ";
+    // published<=? alone lets SQLite range scan idx_videos_published
+    if (seek) sql += "and v.published<=? and (v.published<? or v.id<?) ";
+    sql += "order by v.published desc, v.id desc ";
+    sql += seek ? "limit ?" : "limit ?,?";
+    return sql;
 }
 
 bool AggregateVideoSource::hasMoreVideos() {
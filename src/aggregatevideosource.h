@@ -37,12 +37,19 @@ public:
     QString getName() { return name; }
     void setName(const QString &value) { name = value; }
     void setUnwatched(bool enable) { unwatched = enable; }
+    // the page query, seek continues after the last row of the previous page
+    static QString pageSql(bool unwatched, bool seek);
 
 private:
     QString name;
     bool unwatched;
     bool hasMore;
 
+    // keyset cursor: position after the last row handed out
+    int nextIndex;
+    uint lastPublished;
+    int lastId;
+
 };
 
 #endif // AGGREGATEVIDEOSOURCE_H
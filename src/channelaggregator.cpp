@@ -21,9 +21,13 @@ $END_LICENSE */
 #include "channelaggregator.h"
 #include "ytchannel.h"
 #include "ytsearch.h"
+#include "ytchanneluploads.h"
 #include "searchparams.h"
 #include "database.h"
+#include "subscriptionvideos.h"
 #include "video.h"
+#include "videodetailscache.h"
+#include "pagetokencache.h"
 #ifdef APP_MAC
 #include "macutils.h"
 #endif
@@ -34,12 +38,18 @@ ChannelAggregator::ChannelAggregator(QObject *parent) : QObject(parent),
     unwatchedCount(-1),
     running(false),
     stopped(false),
-    currentChannel(0) {
+    maxConcurrentChecks(4),
+    pendingChecks(0) {
     checkInterval = 1800;
 
     timer = new QTimer(this);
     timer->setInterval(60000 * 5);
     connect(timer, SIGNAL(timeout()), SLOT(run()));
+
+    batchTimer = new QTimer(this);
+    batchTimer->setSingleShot(true);
+    batchTimer->setInterval(60000 * 2);
+    connect(batchTimer, SIGNAL(timeout()), SLOT(batchTimedOut()));
 }
 
 ChannelAggregator* ChannelAggregator::instance() {
@@ -57,20 +67,24 @@ void ChannelAggregator::start() {
 void ChannelAggregator::stop() {
     timer->stop();
     stopped = true;
+    abortChecks();
+    storeBatch();
+    running = false;
 }
 
-YTChannel* ChannelAggregator::getChannelToCheck() {
-    if (stopped) return 0;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select user_id from subscriptions where checked<? "
-                  "order by checked limit 1");
+QList<YTChannel*> ChannelAggregator::getChannelsToCheck(int max) {
+    QList<YTChannel*> channels;
+    if (stopped) return channels;
+    QSqlQuery query = Database::instance().cachedQuery(Database::channelsToCheckSql);
     query.bindValue(0, QDateTime::currentDateTimeUtc().toTime_t() - checkInterval);
+    query.bindValue(1, max);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
-    if (query.next())
-        return YTChannel::forId(query.value(0).toString());
-    return 0;
+    while (query.next()) {
+        YTChannel *channel = YTChannel::forId(query.value(0).toString());
+        if (channel) channels << channel;
+    }
+    return channels;
 }
 
 void ChannelAggregator::run() {
@@ -80,75 +94,145 @@ void ChannelAggregator::run() {
     newVideoCount = 0;
     updatedChannels.clear();
 
-    if (!Database::instance().getConnection().transaction())
-        qWarning() << "Transaction failed" << __PRETTY_FUNCTION__;
-
-    processNextChannel();
+    processNextBatch();
 }
 
-void ChannelAggregator::processNextChannel() {
+void ChannelAggregator::processNextBatch() {
     if (stopped) {
         running = false;
         return;
     }
-    YTChannel* channel = getChannelToCheck();
-    if (channel) {
+    // a batch is already in flight
+    if (pendingChecks > 0) return;
+
+    const QList<YTChannel*> channels = getChannelsToCheck(maxConcurrentChecks);
+    if (channels.isEmpty()) {
+        finish();
+        return;
+    }
+
+    // Results are kept in memory and stored by channelProcessed()
+    // once every check of the batch has reported back
+    pendingChecks = channels.size();
+    batchTimer->start();
+    foreach (YTChannel *channel, channels)
         checkWebPage(channel);
-    } else finish();
+}
+
+void ChannelAggregator::batchTimedOut() {
+    if (pendingChecks <= 0) return;
+    qWarning() << pendingChecks << "channel checks did not complete";
+    abortChecks();
+    storeBatch();
+    QTimer::singleShot(0, this, SLOT(processNextBatch()));
+}
+
+void ChannelAggregator::abortChecks() {
+    batchTimer->stop();
+    foreach (QObject *reply, webPageChecks.keys())
+        reply->disconnect(this);
+    webPageChecks.clear();
+    foreach (QObject *source, searches.keys()) {
+        source->disconnect(this);
+        qobject_cast<PaginatedVideoSource*>(source)->abort();
+        source->deleteLater();
+    }
+    searches.clear();
+    pendingChecks = 0;
 }
 
 void ChannelAggregator::checkWebPage(YTChannel *channel) {
-    currentChannel = channel;
     QString url = "https://www.youtube.com/channel/" + channel->getChannelId() + "/videos";
-    QObject *reply = HttpUtils::yt().get(url);
+    QObject *reply = HttpUtils::yt().get(url, HttpRequest::LowPriority);
+    webPageChecks.insert(reply, channel);
 
     connect(reply, SIGNAL(data(QByteArray)), SLOT(parseWebPage(QByteArray)));
     connect(reply, SIGNAL(error(QString)), SLOT(errorWebPage(QString)));
 }
 
 void ChannelAggregator::parseWebPage(const QByteArray &bytes) {
+    YTChannel *channel = webPageChecks.take(sender());
+    if (!channel) return;
+
     bool hasNewVideos = true;
     QRegExp re = QRegExp("[\\?&]v=([0-9A-Za-z_-]+)");
     if (re.indexIn(bytes) != -1) {
         QString videoId = re.cap(1);
-        QString latestVideoId = currentChannel->latestVideoId();
+        QString latestVideoId = channel->latestVideoId();
         // qDebug() << "Comparing" << videoId << latestVideoId;
         hasNewVideos = videoId != latestVideoId;
     }
     if (hasNewVideos) {
-        if (currentChannel) {
-            reallyProcessChannel(currentChannel);
-            currentChannel = 0;
-        }
+        reallyProcessChannel(channel);
     } else {
-        currentChannel->updateChecked();
-        currentChannel = 0;
-        processNextChannel();
+        channel->updateChecked();
+        channelProcessed();
     }
 }
 
 void ChannelAggregator::errorWebPage(const QString &message) {
     Q_UNUSED(message);
-    reallyProcessChannel(currentChannel);
-    currentChannel = 0;
+    YTChannel *channel = webPageChecks.take(sender());
+    if (!channel) return;
+    reallyProcessChannel(channel);
 }
 
 void ChannelAggregator::reallyProcessChannel(YTChannel *channel) {
-    SearchParams *params = new SearchParams();
-    params->setChannelId(channel->getChannelId());
-    params->setSortBy(SearchParams::SortByNewest);
-    params->setTransient(true);
-    params->setPublishedAfter(channel->getChecked());
-    YTSearch *videoSource = new YTSearch(params, this);
-    connect(videoSource, SIGNAL(gotVideos(QList<Video*>)), SLOT(videosLoaded(QList<Video*>)));
+    PaginatedVideoSource *videoSource;
+    if (!YTChannelUploads::uploadsPlaylistId(channel->getChannelId()).isEmpty()) {
+        YTChannelUploads *uploads = new YTChannelUploads(channel->getChannelId(), this);
+        uploads->setPublishedAfter(channel->getChecked());
+        videoSource = uploads;
+    } else {
+        SearchParams *params = new SearchParams();
+        params->setChannelId(channel->getChannelId());
+        params->setSortBy(SearchParams::SortByNewest);
+        params->setTransient(true);
+        params->setPublishedAfter(channel->getChecked());
+        videoSource = new YTSearch(params, this);
+    }
+    // videos go to the database with their duration and view count
+    videoSource->setAsyncDetails(false);
+    searches.insert(videoSource, channel);
+    connect(videoSource, SIGNAL(gotVideos(QVector<VideoRecord>)),
+            SLOT(videosLoaded(QVector<VideoRecord>)));
+    connect(videoSource, SIGNAL(error(QString)), SLOT(searchError(QString)));
     videoSource->loadVideos(50, 1);
+}
 
-    channel->updateChecked();
+void ChannelAggregator::channelProcessed() {
+    if (--pendingChecks > 0) return;
+    batchTimer->stop();
+    storeBatch();
+    QTimer::singleShot(0, this, SLOT(processNextBatch()));
 }
 
-void ChannelAggregator::finish() {
-    currentChannel = 0;
+void ChannelAggregator::storeBatch() {
+    if (batchVideos.isEmpty()) return;
+
+    QVector<VideoRecord> videos;
+    foreach (const QVector<VideoRecord> &channelVideos, batchVideos)
+        videos += channelVideos;
+
+    // One short transaction, nothing else gets written while it is open
+    QSqlDatabase db = Database::instance().getConnection();
+    if (!db.transaction())
+        qWarning() << "Transaction failed" << __PRETTY_FUNCTION__;
+    addVideos(videos);
+    if (!db.commit()) {
+        qWarning() << "Commit failed" << __PRETTY_FUNCTION__;
+        db.rollback();
+    }
 
+    foreach (YTChannel *channel, batchVideos.keys()) {
+        channel->updateNotifyCount();
+        emit channelChanged(channel);
+    }
+    batchVideos.clear();
+    updateUnwatchedCount();
+}
+
+void ChannelAggregator::finish() {
     /*
     foreach (YTChannel *channel, updatedChannels)
         if (channel->updateNotifyCount())
@@ -156,10 +240,6 @@ void ChannelAggregator::finish() {
     updateUnwatchedCount();
     */
 
-    QSqlDatabase db = Database::instance().getConnection();
-    if (!db.commit())
-        qWarning() << "Commit failed" << __PRETTY_FUNCTION__;
-
     /*
     QByteArray b = db.databaseName().right(20).toLocal8Bit();
     const char* s = b.constData();
@@ -189,107 +269,71 @@ void ChannelAggregator::finish() {
     running = false;
 }
 
-void ChannelAggregator::videosLoaded(const QList<Video*> &videos) {
+void ChannelAggregator::videosLoaded(const QVector<VideoRecord> &videos) {
+    YTChannel *channel = searches.take(sender());
     sender()->deleteLater();
+    if (!channel) return;
 
-    foreach (Video* video, videos) {
-        addVideo(video);
-        qApp->processEvents();
-    }
+    channel->updateChecked();
+    if (!videos.isEmpty()) batchVideos[channel] += videos;
 
-    if (!videos.isEmpty()) {
-        YTChannel *channel = YTChannel::forId(videos.first()->channelId());
-        channel->updateNotifyCount();
-        emit channelChanged(channel);
-        updateUnwatchedCount();
-        foreach (Video* video, videos) video->deleteLater();
-    }
+    channelProcessed();
+}
 
-    QTimer::singleShot(0, this, SLOT(processNextChannel()));
+void ChannelAggregator::searchError(const QString &message) {
+    Q_UNUSED(message);
+    YTChannel *channel = searches.take(sender());
+    sender()->deleteLater();
+    if (!channel) return;
+    channel->updateChecked();
+    channelProcessed();
 }
 
 void ChannelAggregator::updateUnwatchedCount() {
     if (!Database::exists()) return;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select sum(notify_count) from subscriptions");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "select sum(notify_count) from subscriptions");
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
     if (!query.next()) return;
     int newUnwatchedCount = query.value(0).toInt();
+    query.finish();
     if (newUnwatchedCount != unwatchedCount) {
         unwatchedCount = newUnwatchedCount;
         emit unwatchedCountChanged(unwatchedCount);
     }
 }
 
-void ChannelAggregator::addVideo(Video *video) {
-    QSqlDatabase db = Database::instance().getConnection();
-
-    QSqlQuery query(db);
-    query.prepare("select count(*) from subscriptions_videos where video_id=?");
-    query.bindValue(0, video->id());
-    bool success = query.exec();
-    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
-    if (!query.next()) return;
-    int count = query.value(0).toInt();
-    if (count > 0) return;
-
-    // qDebug() << "Inserting" << video->author() << video->title();
-
-    YTChannel *channel = YTChannel::forId(video->channelId());
-    if (!channel) {
-        qWarning() << "channelId not present in db" << video->channelId() << video->channelTitle();
-        return;
+void ChannelAggregator::addVideos(const QVector<VideoRecord> &videos) {
+    if (videos.isEmpty()) return;
+
+    // group by channel so we know which channels actually got new videos
+    QList<YTChannel*> channels;
+    QHash<YTChannel*, QVector<VideoRecord> > channelVideos;
+    foreach (const VideoRecord &video, videos) {
+        YTChannel *channel = YTChannel::forId(video.channelId());
+        if (!channel) {
+            qWarning() << "channelId not present in db" << video.channelId() << video.channelTitle();
+            continue;
+        }
+        if (!channelVideos.contains(channel)) channels << channel;
+        channelVideos[channel] << video;
     }
 
-    if (!updatedChannels.contains(channel))
-        updatedChannels << channel;
-
-    uint now = QDateTime::currentDateTimeUtc().toTime_t();
-    uint published = video->published().toTime_t();
-    if (published > now) {
-        qDebug() << "fixing publish time";
-        published = now;
+    foreach (YTChannel *channel, channels) {
+        const int inserted = SubscriptionVideos::add(channel->getId(), channelVideos[channel]);
+        if (inserted <= 0) continue;
+        newVideoCount += inserted;
+        if (!updatedChannels.contains(channel))
+            updatedChannels << channel;
     }
-
-    query = QSqlQuery(db);
-    query.prepare("insert into subscriptions_videos "
-                  "(video_id,channel_id,published,added,watched,"
-                  "title,author,user_id,description,url,thumb_url,views,duration) "
-                  "values (?,?,?,?,?,?,?,?,?,?,?,?,?)");
-    query.bindValue(0, video->id());
-    query.bindValue(1, channel->getId());
-    query.bindValue(2, published);
-    query.bindValue(3, now);
-    query.bindValue(4, 0);
-    query.bindValue(5, video->title());
-    query.bindValue(6, video->channelTitle());
-    query.bindValue(7, video->channelId());
-    query.bindValue(8, video->description());
-    query.bindValue(9, video->webpage());
-    query.bindValue(10, video->thumbnailUrl());
-    query.bindValue(11, video->viewCount());
-    query.bindValue(12, video->duration());
-    success = query.exec();
-    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
-
-    newVideoCount++;
-
-    query = QSqlQuery(db);
-    query.prepare("update subscriptions set updated=? where user_id=?");
-    query.bindValue(0, published);
-    query.bindValue(1, channel->getChannelId());
-    success = query.exec();
-    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
 }
 
 void ChannelAggregator::markAllAsWatched() {
     uint now = QDateTime::currentDateTimeUtc().toTime_t();
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions set watched=?, notify_count=0");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions set watched=?, notify_count=0");
     query.bindValue(0, now);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
@@ -305,9 +349,8 @@ void ChannelAggregator::markAllAsWatched() {
 
 void ChannelAggregator::videoWatched(Video *video) {
     if (!Database::exists()) return;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions_videos set watched=? where video_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions_videos set watched=? where video_id=?");
     query.bindValue(0, QDateTime::currentDateTimeUtc().toTime_t());
     query.bindValue(1, video->id());
     bool success = query.exec();
@@ -322,6 +365,8 @@ void ChannelAggregator::cleanup() {
     const int maxVideos = 1000;
     const int maxDeletions = 1000;
     if (!Database::exists()) return;
+    VideoDetailsCache::prune();
+    PageTokenCache::prune();
     QSqlDatabase db = Database::instance().getConnection();
 
     QSqlQuery query(db);
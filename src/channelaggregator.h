@@ -23,6 +23,7 @@ $END_LICENSE */
 
 #include <QtCore>
 #include <QtNetwork>
+#include "videorecord.h"
 
 class YTChannel;
 class Video;
@@ -36,7 +37,9 @@ public:
     int getUnwatchedCount() { return unwatchedCount; }
     void markAllAsWatched();
     void videoWatched(Video *video);
+    void addVideos(const QVector<VideoRecord> &videos);
     void cleanup();
+    void setMaxConcurrentChecks(int value) { maxConcurrentChecks = qMax(1, value); }
 
 public slots:
     void start();
@@ -49,17 +52,21 @@ signals:
     void unwatchedCountChanged(int count);
 
 private slots:
-    void videosLoaded(const QList<Video*> &videos);
-    void processNextChannel();
+    void videosLoaded(const QVector<VideoRecord> &videos);
+    void searchError(const QString &message);
+    void processNextBatch();
     void checkWebPage(YTChannel *channel);
     void parseWebPage(const QByteArray &bytes);
     void errorWebPage(const QString &message);
     void reallyProcessChannel(YTChannel *channel);
+    void batchTimedOut();
 
 private:
     ChannelAggregator(QObject *parent = 0);
-    YTChannel* getChannelToCheck();
-    void addVideo(Video* video);
+    QList<YTChannel*> getChannelsToCheck(int max);
+    void channelProcessed();
+    void abortChecks();
+    void storeBatch();
     void finish();
 
     uint checkInterval;
@@ -72,7 +79,14 @@ private:
     QTimer *timer;
     bool stopped;
 
-    YTChannel *currentChannel;
+    // channels checked concurrently in each batch
+    int maxConcurrentChecks;
+    int pendingChecks;
+    QHash<QObject*, YTChannel*> webPageChecks;
+    QHash<QObject*, YTChannel*> searches;
+    // videos loaded by the current batch, not yet in the database
+    QHash<YTChannel*, QVector<VideoRecord> > batchVideos;
+    QTimer *batchTimer;
 };
 
 #endif // CHANNELAGGREGATOR_H
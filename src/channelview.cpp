@@ -167,7 +167,6 @@ void ChannelView::itemActivated(const QModelIndex &index) {
         params->setSortBy(SearchParams::SortByNewest);
         params->setTransient(true);
         YTSearch *videoSource = new YTSearch(params, this);
-        videoSource->setAsyncDetails(true);
         emit activated(videoSource);
         channel->updateWatched();
     } else if (itemType == ChannelModel::ItemAggregate) {
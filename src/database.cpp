@@ -22,9 +22,76 @@ $END_LICENSE */
 #include "constants.h"
 #include <QtDebug>
 
-static const int DATABASE_VERSION = 1;
+static const int INITIAL_VERSION = 1;
+static const int DATABASE_VERSION = 5;
 static const QString dbName = QLatin1String(Constants::UNIX_NAME) + ".db";
 static Database *databaseInstance = 0;
+static Database::Profile profile;
+
+const char *Database::latestVideoIdSql =
+        "select video_id from subscriptions_videos where user_id=? "
+        "order by published desc limit 1";
+const char *Database::unwatchedCountSql =
+        "select count(*) from subscriptions_videos "
+        "where channel_id=? and added>? and published>? and watched=0";
+const char *Database::channelUpdatedSql =
+        "update subscriptions set updated="
+        "(select max(published) from subscriptions_videos where channel_id=?) "
+        "where id=?";
+const char *Database::channelsToCheckSql =
+        "select user_id from subscriptions where checked<? "
+        "order by checked limit ?";
+const char *Database::pruneDetailsSql =
+        "delete from video_details where fetched<?";
+
+namespace {
+
+struct Migration {
+    // schema version reached once all statements for it have run
+    int version;
+    const char *sql;
+};
+
+const Migration migrations[] = {
+    // 2: indexes for the hot subscription queries
+    // YTChannel::latestVideoId()
+    { 2, "create index if not exists idx_videos_user_published "
+         "on subscriptions_videos(user_id, published)" },
+    // SubscriptionVideos::add() max(published) per channel
+    { 2, "create index if not exists idx_videos_channel_published "
+         "on subscriptions_videos(channel_id, published)" },
+    // YTChannel::updateNotifyCount(), covering
+    { 2, "create index if not exists idx_videos_channel_watched "
+         "on subscriptions_videos(channel_id, watched, added, published)" },
+    // AggregateVideoSource, newest first
+    { 2, "create index if not exists idx_videos_published "
+         "on subscriptions_videos(published)" },
+    // ChannelAggregator::getChannelsToCheck(), covering
+    { 2, "create index if not exists idx_checked "
+         "on subscriptions(checked, user_id)" },
+
+    // 3: VideoDetailsCache
+    { 3, "create table if not exists video_details ("
+         "video_id varchar primary key,"
+         "duration integer,"
+         "views integer,"
+         "fetched integer," // last time the API confirmed these values
+         "etag varchar)" },
+
+    // 4: VideoDetailsCache::prune()
+    { 4, "create index if not exists idx_details_fetched "
+         "on video_details(fetched)" },
+
+    // 5: PageTokenCache
+    { 5, "create table if not exists page_tokens ("
+         "chain varchar," // listing url without page token
+         "start_index integer," // of the page the token leads to
+         "token varchar,"
+         "stored integer,"
+         "primary key (chain, start_index))" }
+};
+
+}
 
 Database::Database() {
     QString dataLocation = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
@@ -42,11 +109,16 @@ Database::Database() {
         int databaseVersion = getAttribute("version").toInt();
         if (databaseVersion > DATABASE_VERSION)
             qWarning("Wrong database version: %d", databaseVersion);
+        else if (databaseVersion < DATABASE_VERSION)
+            migrate(databaseVersion);
 
         if (!getAttribute("channelIdFix").toBool())
             fixChannelIds();
 
-    } else createDatabase();
+    } else {
+        createDatabase();
+        migrate(getAttribute("version").toInt());
+    }
 }
 
 Database::~Database() {
@@ -112,7 +184,48 @@ void Database::createDatabase() {
 
     QSqlQuery("create table attributes (name varchar, value)", db);
     QSqlQuery("insert into attributes (name, value) values ('version', "
-              + QString::number(DATABASE_VERSION) + ")", db);
+              + QString::number(INITIAL_VERSION) + ")", db);
+}
+
+/**
+  * Brings the schema from fromVersion to DATABASE_VERSION.
+  * Each version is applied in its own transaction, a failure leaves
+  * the database at the last complete version.
+  */
+void Database::migrate(int fromVersion) {
+    QSqlDatabase db = getConnection();
+    const int count = sizeof(migrations) / sizeof(migrations[0]);
+
+    for (int version = fromVersion + 1; version <= DATABASE_VERSION; ++version) {
+        qDebug() << "Migrating database to version" << version;
+        if (!db.transaction())
+            qWarning() << "Transaction failed" << __PRETTY_FUNCTION__;
+
+        bool success = true;
+        for (int i = 0; i < count && success; ++i) {
+            if (migrations[i].version != version) continue;
+            QSqlQuery query(db);
+            success = query.exec(migrations[i].sql);
+            if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+        }
+
+        if (success) {
+            // attributes has no unique key, so update the row in place
+            QSqlQuery query(db);
+            query.prepare("update attributes set value=? where name='version'");
+            query.bindValue(0, version);
+            success = query.exec();
+            if (!success) qWarning() << query.lastError().text();
+        }
+
+        if (!success) {
+            db.rollback();
+            qWarning("Database migration to version %d failed", version);
+            return;
+        }
+        if (!db.commit())
+            qWarning() << "Commit failed" << __PRETTY_FUNCTION__;
+    }
 }
 
 // static
@@ -163,12 +276,51 @@ QSqlDatabase Database::getConnection() {
         connection.setDatabaseName(dbLocation);
         if(!connection.open()) {
             qWarning() << QString("Cannot connect to database %1 in thread %2").arg(dbLocation, threadName);
-        }
+        } else applyProfile(connection);
         connections.insert(currentThread, connection);
         return connection;
     }
 }
 
+// static
+void Database::setProfile(const Profile &value) {
+    profile = value;
+}
+
+void Database::applyProfile(const QSqlDatabase &connection) {
+    QStringList pragmas;
+    pragmas << QLatin1String("journal_mode=") + (profile.wal ? "wal" : "delete")
+            << QLatin1String("synchronous=") + profile.synchronous
+            << QLatin1String("cache_size=") + QString::number(profile.cacheSize)
+            << QLatin1String("mmap_size=") + QString::number(profile.mmapSize);
+    foreach (const QString &pragma, pragmas) {
+        QSqlQuery query(connection);
+        if (!query.exec("pragma " + pragma))
+            qWarning() << query.lastQuery() << query.lastError().text();
+    }
+}
+
+QSqlQuery Database::cachedQuery(const QString &sql) {
+    QSqlDatabase connection = getConnection();
+    QMutexLocker locker(&lock);
+    QHash<QString, QSqlQuery> &threadQueries = queries[QThread::currentThread()];
+    QHash<QString, QSqlQuery>::iterator i = threadQueries.find(sql);
+    if (i != threadQueries.end()) {
+        // release the previous result set before reusing the statement
+        i.value().finish();
+        return i.value();
+    }
+    QSqlQuery query(connection);
+    // forward only skips the driver's per-row value cache
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        qWarning() << sql << query.lastError().text();
+        return query;
+    }
+    threadQueries.insert(sql, query);
+    return query;
+}
+
 QVariant Database::getAttribute(const QString &name) {
     QSqlQuery query("select value from attributes where name=?", getConnection());
     query.bindValue(0, name);
@@ -241,6 +393,10 @@ void Database::drop() {
 }
 
 void Database::closeConnections() {
+    {
+        QMutexLocker locker(&lock);
+        queries.clear();
+    }
     foreach(QSqlDatabase connection, connections.values()) {
         // qDebug() << "Closing connection" << connection;
         connection.close();
@@ -251,6 +407,10 @@ void Database::closeConnections() {
 void Database::closeConnection() {
     QThread *currentThread = QThread::currentThread();
     if (!connections.contains(currentThread)) return;
+    {
+        QMutexLocker locker(&lock);
+        queries.remove(currentThread);
+    }
     QSqlDatabase connection = connections.take(currentThread);
     // qDebug() << "Closing connection" << connection;
     connection.close();
@@ -258,6 +418,11 @@ void Database::closeConnection() {
 
 void Database::shutdown() {
     if (!databaseInstance) return;
+    {
+        // a statement left mid-result would make vacuum fail with SQLITE_BUSY
+        QMutexLocker locker(&databaseInstance->lock);
+        databaseInstance->queries.clear();
+    }
     QSqlQuery("vacuum", databaseInstance->getConnection());
     databaseInstance->closeConnections();
 }
@@ -29,10 +29,44 @@ class Database : public QObject {
     Q_OBJECT
 
 public:
+    /**
+      * SQLite tuning applied to each new connection
+      */
+    struct Profile {
+        Profile() : wal(true), synchronous("normal"),
+            cacheSize(-8192), mmapSize(64 * 1024 * 1024) { }
+        // WAL lets readers proceed while the aggregator commits
+        bool wal;
+        QString synchronous;
+        // pages if positive, KiB if negative, as in the pragma
+        int cacheSize;
+        qint64 mmapSize;
+    };
+
     static bool exists();
     static Database& instance();
     static void shutdown();
+    static void setProfile(const Profile &value);
     QSqlDatabase getConnection();
+
+    /**
+      * Returns a query prepared once per connection and reused afterwards.
+      * Copies share the prepared statement, so bind and exec it right away.
+      * Results are forward only. Callers that stop before the last row
+      * must call finish(), an active statement holds back WAL checkpoints.
+      */
+    QSqlQuery cachedQuery(const QString &sql);
+
+    /**
+      * Hot queries served by the indexes the migrations create.
+      * tests/queryplans checks that SQLite actually uses them.
+      */
+    static const char *latestVideoIdSql;
+    static const char *unwatchedCountSql;
+    static const char *channelUpdatedSql;
+    static const char *channelsToCheckSql;
+    static const char *pruneDetailsSql;
+
     ~Database();
     void drop();
     void closeConnections();
@@ -45,11 +79,14 @@ private:
     QVariant getAttribute(const QString &name);
     void setAttribute(const QString &name, const QVariant &value);
 
+    void migrate(int fromVersion);
     void fixChannelIds();
+    void applyProfile(const QSqlDatabase &connection);
 
     QMutex lock;
     QString dbLocation;
     QHash<QThread*, QSqlDatabase> connections;
+    QHash<QThread*, QHash<QString, QSqlQuery> > queries;
 
 };
 
@@ -230,6 +230,7 @@ void DownloadItem::error(QNetworkReply::NetworkError) {
     m_reply = 0;
     m_status = Failed;
 
+    emit error(m_errorMessage);
     emit finished();
 }
 
@@ -317,7 +318,7 @@ void DownloadItem::speedCheck() {
         // too slow! retry
         qDebug() << "Retrying...";
         connect(video, SIGNAL(gotStreamUrl(QUrl)), SLOT(gotStreamUrl(QUrl)), Qt::UniqueConnection);
-        video->loadStreamUrl();
+        video->reloadStreamUrl();
     }
 }
 
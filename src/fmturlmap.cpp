@@ -0,0 +1,67 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "fmturlmap.h"
+
+namespace {
+
+// skips the round trip through QByteArray when there's nothing to decode
+QString percentDecoded(const QStringRef &s) {
+    if (s.indexOf(QLatin1Char('%')) == -1) return s.toString();
+    return QString::fromUtf8(QByteArray::fromPercentEncoding(s.toUtf8()));
+}
+
+}
+
+QVector<FmtUrlMap::Format> FmtUrlMap::parse(const QString &fmtUrlMap) {
+    QVector<Format> formats;
+    const int mapSize = fmtUrlMap.size();
+    int entryEnd = -1;
+    for (int entryStart = 0; entryStart < mapSize; entryStart = entryEnd + 1) {
+        entryEnd = fmtUrlMap.indexOf(QLatin1Char(','), entryStart);
+        if (entryEnd == -1) entryEnd = mapSize;
+        if (entryEnd == entryStart) continue;
+
+        Format format;
+        int paramEnd = -1;
+        for (int paramStart = entryStart; paramStart < entryEnd; paramStart = paramEnd + 1) {
+            paramEnd = fmtUrlMap.indexOf(QLatin1Char('&'), paramStart);
+            if (paramEnd == -1 || paramEnd > entryEnd) paramEnd = entryEnd;
+            const int separator = fmtUrlMap.indexOf(QLatin1Char('='), paramStart);
+            if (separator == -1 || separator > paramEnd) continue;
+
+            const QStringRef key(&fmtUrlMap, paramStart, separator - paramStart);
+            const QStringRef value(&fmtUrlMap, separator + 1, paramEnd - separator - 1);
+            if (key == QLatin1String("itag")) {
+                format.itag = value.toInt();
+            } else if (key == QLatin1String("url")) {
+                format.url = percentDecoded(value);
+            } else if (key == QLatin1String("sig")) {
+                format.sig = percentDecoded(value);
+                format.encrypted = false;
+            } else if (key == QLatin1String("s")) {
+                format.sig = percentDecoded(value);
+                format.encrypted = true;
+            }
+        }
+        formats << format;
+    }
+    return formats;
+}
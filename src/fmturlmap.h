@@ -0,0 +1,53 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef FMTURLMAP_H
+#define FMTURLMAP_H
+
+#include <QtCore>
+
+/**
+  * Tokenizer for the url_encoded_fmt_stream_map of get_video_info
+  * and of the watch page: comma separated formats, each a list of
+  * &-separated key=value params.
+  */
+class FmtUrlMap {
+
+public:
+    struct Format {
+        Format() : itag(-1), encrypted(false) { }
+        // -1 when missing
+        int itag;
+        // percent-decoded, empty when missing
+        QString url;
+        QString sig;
+        // sig came from "s" and has to be deciphered with the js player
+        bool encrypted;
+    };
+
+    // Single pass, only the params above are copied and decoded
+    static QVector<Format> parse(const QString &fmtUrlMap);
+
+private:
+    FmtUrlMap() { }
+
+};
+
+#endif // FMTURLMAP_H
@@ -12,48 +12,123 @@ QString requestHash(const HttpRequest &req) {
         s += sep;
         s += QLatin1String("POST");
     }
+    // a conditional request may get a 304 instead of a body
+    const QByteArray etag = req.headers.value("If-None-Match");
+    if (!etag.isEmpty()) {
+        s += sep;
+        s += QString::fromLatin1(etag);
+    }
     return LocalCache::hash(s);
 }
 
+class CacheInsertTask : public QRunnable {
+
+public:
+    CacheInsertTask(LocalCache *cache, const QString &key, const QByteArray &value) :
+        cache(cache), key(key), value(value) { }
+
+    void run() {
+        cache->insert(key, value);
+    }
+
+private:
+    LocalCache *cache;
+    QString key;
+    QByteArray value;
+};
+
 }
 
-CachedHttpReply::CachedHttpReply(LocalCache *cache, const QString &key, const HttpRequest &req) :
+CacheLookupTask::CacheLookupTask(LocalCache *cache, const QString &key) :
     cache(cache),
-    key(key),
-    req(req) {
-    QTimer::singleShot(0, this, SLOT(emitSignals()));
+    key(key) {
+    // deleted via deleteLater() once the result is out
+    setAutoDelete(false);
 }
 
-QByteArray CachedHttpReply::body() const {
-    return cache->value(key);
+void CacheLookupTask::run() {
+    QByteArray bytes;
+    if (cache->isCached(key)) {
+        bytes = cache->value(key);
+        if (!bytes.isNull()) cache->memoryInsert(key, bytes);
+    }
+    // the reply only deletes itself after getting one of these
+    if (bytes.isNull())
+        emit miss();
+    else
+        emit hit(bytes);
+    deleteLater();
 }
 
-void CachedHttpReply::emitSignals() {
-    emit data(body());
+CachedHttpReply::CachedHttpReply(CachedHttp &cachedHttp, LocalCache *cache, const QString &key,
+                                 const HttpRequest &req) :
+    cachedHttp(cachedHttp),
+    cache(cache),
+    key(key),
+    req(req) {
+    const QByteArray bytes = cache->memoryValue(key);
+    if (!bytes.isNull()) {
+        QMetaObject::invokeMethod(this, "cacheHit", Qt::QueuedConnection, Q_ARG(QByteArray, bytes));
+        return;
+    }
+    CacheLookupTask *task = new CacheLookupTask(cache, key);
+    connect(task, SIGNAL(hit(QByteArray)), SLOT(cacheHit(QByteArray)), Qt::QueuedConnection);
+    connect(task, SIGNAL(miss()), SLOT(cacheMiss()), Qt::QueuedConnection);
+    CachedHttp::ioThreadPool()->start(task);
+}
+
+void CachedHttpReply::cacheHit(const QByteArray &bytes) {
+    // qDebug() << "CachedHttp HIT" << req.url;
+    this->bytes = bytes;
+    emit data(bytes);
     emit finished(*this);
     deleteLater();
 }
 
-WrappedHttpReply::WrappedHttpReply(LocalCache *cache, const QString &key, QObject *httpReply) :
+void CachedHttpReply::cacheMiss() {
+    // qDebug() << "CachedHttp MISS" << req.url.toString();
+    QObject *reply = cachedHttp.originRequest(key, req);
+    connect(reply, SIGNAL(data(QByteArray)), SIGNAL(data(QByteArray)));
+    connect(reply, SIGNAL(error(QString)), SIGNAL(error(QString)));
+    connect(reply, SIGNAL(finished(HttpReply)), SIGNAL(finished(HttpReply)));
+
+    // this will cause the deletion of this object once the request is finished
+    setParent(reply);
+}
+
+WrappedHttpReply::WrappedHttpReply(CachedHttp &cachedHttp, LocalCache *cache, const QString &key,
+                                   QObject *httpReply, HttpRequest::Priority priority) :
     QObject(httpReply),
+    cachedHttp(cachedHttp),
     cache(cache),
     key(key),
-    httpReply(httpReply) {
+    httpReply(httpReply),
+    priority(priority) {
     connect(httpReply, SIGNAL(data(QByteArray)), SIGNAL(data(QByteArray)));
     connect(httpReply, SIGNAL(error(QString)), SIGNAL(error(QString)));
     connect(httpReply, SIGNAL(finished(HttpReply)), SLOT(originFinished(HttpReply)));
 }
 
+WrappedHttpReply::~WrappedHttpReply() {
+    cachedHttp.removeInFlight(key, this);
+}
+
 void WrappedHttpReply::originFinished(const HttpReply &reply) {
-    if (reply.isSuccessful())
-        cache->insert(key, reply.body());
+    // Late duplicates must not attach to a finished request
+    cachedHttp.removeInFlight(key, this);
+    if (reply.isSuccessful()) {
+        const QByteArray bytes = reply.body();
+        cache->memoryInsert(key, bytes);
+        CachedHttp::ioThreadPool()->start(new CacheInsertTask(cache, key, bytes));
+    }
     emit finished(reply);
 }
 
-CachedHttp::CachedHttp(Http &http, const QString &name) :
+CachedHttp::CachedHttp(Http &http, const QString &name, LocalCache::Backend backend) :
     http(http),
-    cache(LocalCache::instance(name)),
-    cachePostRequests(false) { }
+    cache(LocalCache::instance(name, backend)),
+    cachePostRequests(false),
+    coalescedCount(0) { }
 
 void CachedHttp::setMaxSeconds(uint seconds) {
     cache->setMaxSeconds(seconds);
@@ -63,6 +138,47 @@ void CachedHttp::setMaxSize(uint maxSize) {
     cache->setMaxSize(maxSize);
 }
 
+void CachedHttp::setMaxMemorySize(uint maxSize) {
+    cache->setMaxMemorySize(maxSize);
+}
+
+QObject *CachedHttp::originRequest(const QString &key, const HttpRequest &req) {
+    WrappedHttpReply *reply = inFlight.value(key);
+    if (reply) {
+        // a more urgent duplicate must not wait behind a background request
+        bool canJoin = req.priority <= reply->getPriority();
+        if (!canJoin && http.promote(reply->getHttpReply(), req.priority)) {
+            reply->setPriority(req.priority);
+            canJoin = true;
+        }
+        if (canJoin) {
+            coalescedCount++;
+            // qDebug() << "CachedHttp COALESCED" << req.url << coalescedCount;
+            return reply;
+        }
+    }
+    // later duplicates join the newest request
+    reply = new WrappedHttpReply(*this, cache, key, http.request(req), req.priority);
+    inFlight.insert(key, reply);
+    return reply;
+}
+
+void CachedHttp::removeInFlight(const QString &key, WrappedHttpReply *reply) {
+    QHash<QString, WrappedHttpReply*>::iterator i = inFlight.find(key);
+    if (i != inFlight.end() && i.value() == reply) inFlight.erase(i);
+}
+
+QThreadPool *CachedHttp::ioThreadPool() {
+    static QThreadPool *pool = [] {
+        QThreadPool *pool = new QThreadPool();
+        // A single thread keeps lookups and inserts in submission order
+        pool->setMaxThreadCount(1);
+        pool->setExpiryTimeout(-1);
+        return pool;
+    }();
+    return pool;
+}
+
 QObject *CachedHttp::request(const HttpRequest &req) {
     bool cacheable = req.operation == QNetworkAccessManager::GetOperation ||
             (cachePostRequests && req.operation == QNetworkAccessManager::PostOperation);
@@ -71,10 +187,8 @@ QObject *CachedHttp::request(const HttpRequest &req) {
         return http.request(req);
     }
     const QString key = requestHash(req);
-    if (cache->isCached(key)) {
-        // qDebug() << "CachedHttp HIT" << req.url;
-        return new CachedHttpReply(cache, key, req);
-    }
-    // qDebug() << "CachedHttp MISS" << req.url.toString();
-    return new WrappedHttpReply(cache, key, http.request(req));
+    // skip the lookup but still refresh the cached copy
+    if (req.headers.value("Cache-Control") == "no-cache")
+        return originRequest(key, req);
+    return new CachedHttpReply(*this, cache, key, req);
 }
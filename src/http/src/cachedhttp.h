@@ -2,22 +2,65 @@
 #define CACHEDHTTP_H
 
 #include "http.h"
+#include "localcache.h"
 
-class LocalCache;
+class WrappedHttpReply;
 
+/**
+ * @brief Caching Http decorator.
+ *
+ * Cache reads, writes and expiry run on a dedicated I/O thread,
+ * results are delivered back to the requesting thread via queued calls.
+ * Identical requests issued while one is already in flight share its reply.
+ */
 class CachedHttp : public Http {
 
 public:
-    CachedHttp(Http &http = Http::instance(), const QString &name = "http");
+    CachedHttp(Http &http = Http::instance(), const QString &name = "http",
+               LocalCache::Backend backend = LocalCache::FilesBackend);
     void setMaxSeconds(uint seconds);
     void setMaxSize(uint maxSize);
+    void setMaxMemorySize(uint maxSize);
     void setCachePostRequests(bool value) { cachePostRequests = value; }
     QObject *request(const HttpRequest &req);
 
+    // Number of requests served by attaching to an identical in-flight request.
+    // A more urgent duplicate promotes the request it joins, or gets its own.
+    uint getCoalescedCount() const { return coalescedCount; }
+
+    QObject *originRequest(const QString &key, const HttpRequest &req);
+    void removeInFlight(const QString &key, WrappedHttpReply *reply);
+
+    static QThreadPool *ioThreadPool();
+
 private:
     Http &http;
     LocalCache *cache;
     bool cachePostRequests;
+    QHash<QString, WrappedHttpReply*> inFlight;
+    uint coalescedCount;
+};
+
+/**
+ * Looks up a key on the I/O thread. The result is a signal queued to the
+ * reply that started the lookup, so it's dropped if the reply is gone.
+ */
+class CacheLookupTask : public QObject, public QRunnable {
+
+    Q_OBJECT
+
+public:
+    CacheLookupTask(LocalCache *cache, const QString &key);
+
+signals:
+    void hit(const QByteArray &bytes);
+    void miss();
+
+private:
+    void run();
+
+    LocalCache *cache;
+    QString key;
 };
 
 class CachedHttpReply : public HttpReply {
@@ -25,18 +68,22 @@ class CachedHttpReply : public HttpReply {
     Q_OBJECT
 
 public:
-    CachedHttpReply(LocalCache *cache, const QString &key, const HttpRequest &req);
+    CachedHttpReply(CachedHttp &cachedHttp, LocalCache *cache, const QString &key,
+                    const HttpRequest &req);
     QUrl url() const { return req.url; }
     int statusCode() const { return 200; }
-    QByteArray body() const;
+    QByteArray body() const { return bytes; }
 
 private slots:
-    void emitSignals();
+    void cacheHit(const QByteArray &bytes);
+    void cacheMiss();
 
 private:
+    CachedHttp &cachedHttp;
     LocalCache *cache;
     QString key;
-    const HttpRequest &req;
+    HttpRequest req;
+    QByteArray bytes;
 };
 
 class WrappedHttpReply : public QObject {
@@ -44,7 +91,12 @@ class WrappedHttpReply : public QObject {
     Q_OBJECT
 
 public:
-    WrappedHttpReply(LocalCache *cache, const QString &key, QObject *httpReply);
+    WrappedHttpReply(CachedHttp &cachedHttp, LocalCache *cache, const QString &key,
+                     QObject *httpReply, HttpRequest::Priority priority);
+    ~WrappedHttpReply();
+    QObject *getHttpReply() const { return httpReply; }
+    HttpRequest::Priority getPriority() const { return priority; }
+    void setPriority(HttpRequest::Priority value) { priority = value; }
 
 signals:
     void data(const QByteArray &bytes);
@@ -55,9 +107,12 @@ private slots:
     void originFinished(const HttpReply &reply);
 
 private:
+    CachedHttp &cachedHttp;
     LocalCache *cache;
     QString key;
     QObject *httpReply;
+    // highest priority among the requests sharing this reply
+    HttpRequest::Priority priority;
 
 };
 
@@ -23,7 +23,8 @@ static int defaultReadTimeout = 10000;
 
 Http::Http() :
     requestHeaders(getDefaultRequestHeaders()),
-    readTimeout(defaultReadTimeout) {
+    readTimeout(defaultReadTimeout),
+    http2Allowed(false) {
 }
 
 void Http::setRequestHeaders(const QHash<QByteArray, QByteArray> &headers) {
@@ -61,19 +62,45 @@ void Http::setDefaultReadTimeout(int timeout) {
     defaultReadTimeout = timeout;
 }
 
+void Http::preconnect(const QString &host, bool http2) {
+#ifdef QT_NO_SSL
+    Q_UNUSED(host);
+    Q_UNUSED(http2);
+#else
+#if QT_VERSION >= 0x050D00
+    if (http2) {
+        // advertise h2 so the connection can be taken over by HTTP/2 requests
+        QSslConfiguration conf = QSslConfiguration::defaultConfiguration();
+        conf.setAllowedNextProtocols(QList<QByteArray>()
+                                     << QSslConfiguration::ALPNProtocolHTTP2
+                                     << QSslConfiguration::NextProtocolHttp1_1);
+        networkAccessManager()->connectToHostEncrypted(host, 443, conf);
+        return;
+    }
+#else
+    Q_UNUSED(http2);
+#endif
+    networkAccessManager()->connectToHostEncrypted(host);
+#endif
+}
+
 QNetworkReply *Http::networkReply(const HttpRequest &req) {
     QNetworkRequest request(req.url);
 
-    QHash<QByteArray, QByteArray> &headers = requestHeaders;
-    if (!req.headers.isEmpty()) headers = req.headers;
-
+    // request headers add to, or override, the defaults
     QHash<QByteArray, QByteArray>::const_iterator it;
-    for (it = headers.constBegin(); it != headers.constEnd(); ++it)
+    for (it = requestHeaders.constBegin(); it != requestHeaders.constEnd(); ++it)
+        request.setRawHeader(it.key(), it.value());
+    for (it = req.headers.constBegin(); it != req.headers.constEnd(); ++it)
         request.setRawHeader(it.key(), it.value());
 
     if (req.offset > 0)
         request.setRawHeader("Range", QString("bytes=%1-").arg(req.offset).toUtf8());
 
+#if QT_VERSION >= 0x050800
+    if (http2Allowed) request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+
     QNetworkAccessManager *manager = networkAccessManager();
 
     QNetworkReply *networkReply = 0;
@@ -102,6 +129,13 @@ QObject* Http::request(const HttpRequest &req) {
     return new NetworkHttpReply(req, *this);
 }
 
+bool Http::promote(QObject *reply, HttpRequest::Priority priority) {
+    Q_UNUSED(reply);
+    Q_UNUSED(priority);
+    // requests are sent right away, none is ever waiting
+    return true;
+}
+
 QObject* Http::request(const QUrl &url,
                        QNetworkAccessManager::Operation operation,
                        const QByteArray& body,
@@ -114,8 +148,11 @@ QObject* Http::request(const QUrl &url,
     return request(req);
 }
 
-QObject* Http::get(const QUrl &url) {
-    return request(url, QNetworkAccessManager::GetOperation);
+QObject* Http::get(const QUrl &url, HttpRequest::Priority priority) {
+    HttpRequest req;
+    req.url = url;
+    req.priority = priority;
+    return request(req);
 }
 
 QObject* Http::head(const QUrl &url) {
@@ -155,7 +192,9 @@ QObject* Http::post(const QUrl &url, QByteArray body, const QByteArray &contentT
 
 NetworkHttpReply::NetworkHttpReply(const HttpRequest &req, Http &http) :
     http(http), req(req),
-    retryCount(0) {
+    retryCount(0),
+    connectTime(-1),
+    firstByteTime(-1) {
 
     if (req.url.isEmpty()) {
         qWarning() << "Empty URL";
@@ -173,6 +212,14 @@ NetworkHttpReply::NetworkHttpReply(const HttpRequest &req, Http &http) :
 }
 
 void NetworkHttpReply::setupReply() {
+    timer.start();
+    connectTime = -1;
+    firstByteTime = -1;
+#ifndef QT_NO_SSL
+    connect(networkReply, SIGNAL(encrypted()), SLOT(replyEncrypted()), Qt::UniqueConnection);
+#endif
+    connect(networkReply, SIGNAL(metaDataChanged()),
+            SLOT(replyMetaDataChanged()), Qt::UniqueConnection);
     connect(networkReply, SIGNAL(error(QNetworkReply::NetworkError)),
             SLOT(replyError(QNetworkReply::NetworkError)), Qt::UniqueConnection);
     connect(networkReply, SIGNAL(finished()),
@@ -224,6 +271,7 @@ void NetworkHttpReply::replyFinished() {
 #endif
     }
 
+    logTiming();
     emit finished(*this);
 
     readTimeoutTimer->stop();
@@ -288,6 +336,31 @@ void NetworkHttpReply::readTimeout() {
     readTimeoutTimer->start();
 }
 
+void NetworkHttpReply::replyEncrypted() {
+    // only emitted when a new connection had to be set up
+    connectTime = timer.elapsed();
+}
+
+void NetworkHttpReply::replyMetaDataChanged() {
+    if (firstByteTime == -1) firstByteTime = timer.elapsed();
+}
+
+void NetworkHttpReply::logTiming() {
+#ifndef QT_NO_DEBUG_OUTPUT
+    if (networkReply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool()) return;
+    const qint64 total = timer.elapsed();
+    const qint64 ttfb = firstByteTime == -1 ? total : firstByteTime;
+    QString protocol = QStringLiteral("http/1.1");
+#if QT_VERSION >= 0x050900
+    if (networkReply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool())
+        protocol = QStringLiteral("h2");
+#endif
+    qDebug() << "Http timing:" << networkReply->url().host() << protocol
+             << "connect" << connectTime << "ttfb" << ttfb
+             << "transfer" << total - ttfb << "ms";
+#endif
+}
+
 QUrl NetworkHttpReply::url() const {
     return networkReply->url();
 }
@@ -6,12 +6,23 @@
 class HttpRequest {
 
 public:
-    HttpRequest() : operation(QNetworkAccessManager::GetOperation), offset(0) { }
+    // Scheduling hint for throttled requests, higher goes first
+    enum Priority {
+        LowPriority = 0, // background work, e.g. subscription checks
+        ThumbnailPriority, // images of visible rows, after the listings they belong to
+        NormalPriority,
+        HighPriority, // the user is waiting for it, e.g. a search
+        PriorityCount
+    };
+
+    HttpRequest() : operation(QNetworkAccessManager::GetOperation), offset(0),
+        priority(NormalPriority) { }
     QUrl url;
     QNetworkAccessManager::Operation operation;
     QByteArray body;
     uint offset;
     QHash<QByteArray, QByteArray> headers;
+    Priority priority;
 };
 
 class Http {
@@ -30,13 +41,23 @@ public:
     void setReadTimeout(int timeout);
     int getReadTimeout() { return readTimeout; }
 
+    // Lets requests multiplex over HTTP/2 where the server supports it (Qt 5.8+)
+    void setHttp2Allowed(bool value) { http2Allowed = value; }
+    bool isHttp2Allowed() const { return http2Allowed; }
+
+    // Opens a TLS connection to host ahead of the first request in this thread
+    static void preconnect(const QString &host, bool http2 = false);
+
     QNetworkReply* networkReply(const HttpRequest &req);
     virtual QObject* request(const HttpRequest &req);
+    // Raises the priority of a reply returned by request() that may still be waiting.
+    // Returns false if this Http cannot do that for the reply.
+    virtual bool promote(QObject *reply, HttpRequest::Priority priority);
     QObject* request(const QUrl &url,
                      QNetworkAccessManager::Operation operation = QNetworkAccessManager::GetOperation,
                      const QByteArray &body = QByteArray(),
                      uint offset = 0);
-    QObject* get(const QUrl &url);
+    QObject* get(const QUrl &url, HttpRequest::Priority priority = HttpRequest::NormalPriority);
     QObject* head(const QUrl &url);
     QObject* post(const QUrl &url, const QMap<QString, QString>& params);
     QObject *post(const QUrl &url, QByteArray body, const QByteArray &contentType);
@@ -44,6 +65,7 @@ public:
 private:
     QHash<QByteArray, QByteArray> requestHeaders;
     int readTimeout;
+    bool http2Allowed;
 
 };
 
@@ -91,11 +113,14 @@ private slots:
     void replyError(QNetworkReply::NetworkError);
     void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void readTimeout();
+    void replyEncrypted();
+    void replyMetaDataChanged();
 
 private:
     void setupReply();
     QString errorMessage();
     void emitError();
+    void logTiming();
 
     Http &http;
     HttpRequest req;
@@ -104,6 +129,12 @@ private:
     int retryCount;
     QByteArray bytes;
 
+    // timing of the current attempt, -1 when not reached.
+    // connectTime stays -1 on a reused connection.
+    QElapsedTimer timer;
+    qint64 connectTime;
+    qint64 firstByteTime;
+
 };
 
 #endif // HTTP_H
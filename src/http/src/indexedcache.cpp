@@ -0,0 +1,425 @@
+#include "indexedcache.h"
+
+#include <algorithm>
+
+namespace {
+
+// "mtc1"
+const quint32 recordMagic = 0x6d746331;
+const int recordHeaderSize = 16;
+
+// a record with a negative value size marks the key as removed
+const qint32 tombstoneSize = -1;
+
+// start compacting once the active pack is bigger than this
+// and more than half of it is dead records
+const qint64 minCompactionSize = 1024 * 1024 * 4;
+
+// entries moved to the new pack on each insert while compacting
+const int compactionBatch = 32;
+
+QString packFileName(int generation) {
+    return QString::number(generation) + QLatin1String(".pack");
+}
+
+}
+
+IndexedCache::IndexedCache(const QString &name) : LocalCache(name),
+    loaded(false),
+    lruHead(0),
+    lruTail(0) { }
+
+IndexedCache::~IndexedCache() {
+    qDeleteAll(index);
+    foreach (Pack *pack, packs) {
+        pack->file->close();
+        delete pack->file;
+        delete pack;
+    }
+}
+
+bool IndexedCache::isCached(const QString &key) {
+    QMutexLocker locker(&mutex);
+    load();
+    Entry *entry = index.value(key);
+    bool cached = entry != 0;
+    if (cached && isExpired(entry)) {
+        remove(entry);
+        cached = false;
+    }
+#ifndef QT_NO_DEBUG_OUTPUT
+    if (!cached) misses++;
+#endif
+    return cached;
+}
+
+QByteArray IndexedCache::value(const QString &key) {
+    QMutexLocker locker(&mutex);
+    load();
+    Entry *entry = index.value(key);
+    if (!entry) {
+#ifndef QT_NO_DEBUG_OUTPUT
+        misses++;
+#endif
+        return QByteArray();
+    }
+    QByteArray bytes = readValue(entry);
+    if (bytes.size() != entry->size) {
+        qWarning() << __PRETTY_FUNCTION__ << "Corrupted entry" << key;
+        remove(entry);
+#ifndef QT_NO_DEBUG_OUTPUT
+        misses++;
+#endif
+        return QByteArray();
+    }
+    touch(entry);
+#ifndef QT_NO_DEBUG_OUTPUT
+    hits++;
+#endif
+    return bytes;
+}
+
+void IndexedCache::insert(const QString &key, const QByteArray &value) {
+    QMutexLocker locker(&mutex);
+    load();
+    if (packs.isEmpty()) return;
+
+    Pack *pack = packs.last();
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    qint64 offset;
+    if (!writeRecord(pack, key, value, now, &offset)) return;
+
+    Entry *entry = index.value(key);
+    if (entry) {
+        entry->pack->liveBytes -= entry->size;
+        entry->pack->entries.remove(entry);
+        size -= entry->size;
+        unlink(entry);
+    } else {
+        entry = new Entry();
+        entry->key = key;
+        index.insert(key, entry);
+    }
+    entry->pack = pack;
+    entry->offset = offset;
+    entry->size = value.size();
+    entry->created = now;
+    pack->entries.insert(entry);
+    pack->liveBytes += entry->size;
+    size += entry->size;
+    link(entry);
+    dropEmptyPacks();
+
+    ++insertCount;
+    if (maxSize > 0 && size > maxSize) expire();
+
+    if (packs.size() > 1) compactStep();
+    else maybeStartCompaction();
+}
+
+bool IndexedCache::clear() {
+    QMutexLocker locker(&mutex);
+    clearMemory();
+#ifndef QT_NO_DEBUG_OUTPUT
+    hits = 0;
+    misses = 0;
+#endif
+    qDeleteAll(index);
+    index.clear();
+    lruHead = lruTail = 0;
+    foreach (Pack *pack, packs) {
+        pack->file->close();
+        delete pack->file;
+        delete pack;
+    }
+    packs.clear();
+    size = 0;
+    insertCount = 0;
+    loaded = false;
+    return QDir(directory).removeRecursively();
+}
+
+void IndexedCache::load() {
+    if (loaded) return;
+    loaded = true;
+
+    QDir dir(directory);
+    if (!dir.exists() && !QDir().mkpath(directory)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Cannot create" << directory;
+        return;
+    }
+
+    // Leftovers from the one file per entry backend
+    foreach (const QString &subdir, dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        QDir(directory + subdir).removeRecursively();
+
+    QList<int> generations;
+    foreach (const QString &fileName, dir.entryList(QStringList("*.pack"), QDir::Files)) {
+        bool ok;
+        int generation = fileName.section('.', 0, 0).toInt(&ok);
+        if (ok) generations << generation;
+    }
+    std::sort(generations.begin(), generations.end());
+
+    // Older packs are loaded first so newer records win
+    foreach (int generation, generations) {
+        Pack *pack = openPack(generation);
+        if (pack) loadPack(pack);
+    }
+
+    if (packs.isEmpty()) openPack(0);
+
+    // Packs fully superseded by newer records
+    dropEmptyPacks();
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    qDebug() << "IndexedCache:" << name << index.size() << "entries" << size << "bytes"
+             << packs.size() << "packs";
+#endif
+}
+
+void IndexedCache::loadPack(Pack *pack) {
+    QFile *file = pack->file;
+    const qint64 fileSize = file->size();
+    qint64 pos = 0;
+    file->seek(0);
+
+    while (pos < fileSize) {
+        if (fileSize - pos < recordHeaderSize) break;
+        QByteArray header = file->read(recordHeaderSize);
+        QDataStream stream(header);
+        quint32 magic;
+        quint32 keyLength;
+        qint32 valueSize;
+        quint32 created;
+        stream >> magic >> keyLength >> valueSize >> created;
+        if (magic != recordMagic) break;
+
+        const qint64 valueOffset = pos + recordHeaderSize + keyLength;
+        const qint64 recordEnd = valueOffset + qMax(valueSize, 0);
+        if (recordEnd > fileSize) break;
+
+        const QString key = QString::fromUtf8(file->read(keyLength));
+
+        if (valueSize < 0 && valueSize != tombstoneSize) {
+            // garbled size, leave whatever the index has for this key alone
+            qWarning() << __PRETTY_FUNCTION__ << "Skipping record with size" << valueSize << key;
+            pos = recordEnd;
+            if (!file->seek(pos)) break;
+            continue;
+        }
+
+        Entry *entry = index.value(key);
+        if (entry) {
+            entry->pack->liveBytes -= entry->size;
+            entry->pack->entries.remove(entry);
+            size -= entry->size;
+            unlink(entry);
+        }
+
+        if (valueSize == tombstoneSize) {
+            if (entry) {
+                index.remove(key);
+                delete entry;
+            }
+        } else {
+            if (!entry) {
+                entry = new Entry();
+                entry->key = key;
+                index.insert(key, entry);
+            }
+            entry->pack = pack;
+            entry->offset = valueOffset;
+            entry->size = valueSize;
+            entry->created = created;
+            pack->entries.insert(entry);
+            pack->liveBytes += valueSize;
+            size += valueSize;
+            // file order approximates access order
+            link(entry);
+        }
+
+        pos = recordEnd;
+        if (!file->seek(pos)) break;
+    }
+
+    if (pos < fileSize) {
+        // Truncated or garbled tail, most likely an interrupted write
+        qWarning() << __PRETTY_FUNCTION__ << "Truncating" << file->fileName() << "at" << pos;
+        file->resize(pos);
+    }
+}
+
+IndexedCache::Pack *IndexedCache::openPack(int generation) {
+    QFile *file = new QFile(directory + packFileName(generation));
+    if (!file->open(QIODevice::ReadWrite)) {
+        qWarning() << __PRETTY_FUNCTION__ << file->fileName() << file->errorString();
+        delete file;
+        return 0;
+    }
+    Pack *pack = new Pack();
+    pack->file = file;
+    pack->generation = generation;
+    packs << pack;
+    return pack;
+}
+
+void IndexedCache::dropEmptyPacks() {
+    // Tombstones only shadow records in older packs, so dropping packs
+    // oldest first never brings a removed key back on the next load().
+    // An emptied pack with older ones still around waits for them.
+    while (packs.size() > 1 && packs.first()->entries.isEmpty())
+        dropPack(packs.first());
+}
+
+void IndexedCache::dropPack(Pack *pack) {
+    // The active pack is never dropped, newer packs only after the older ones
+    if (pack == packs.last() || pack != packs.first()) return;
+    foreach (Entry *entry, pack->entries) {
+        index.remove(entry->key);
+        unlink(entry);
+        size -= entry->size;
+        delete entry;
+    }
+    packs.removeOne(pack);
+    pack->file->close();
+    pack->file->remove();
+    delete pack->file;
+    delete pack;
+}
+
+bool IndexedCache::writeRecord(Pack *pack, const QString &key, const QByteArray &value,
+                               uint created, qint64 *valueOffset) {
+    const QByteArray keyBytes = key.toUtf8();
+    const qint32 valueSize = valueOffset ? value.size() : tombstoneSize;
+
+    QByteArray header;
+    header.reserve(recordHeaderSize + keyBytes.size());
+    {
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream << recordMagic << quint32(keyBytes.size()) << valueSize << quint32(created);
+    }
+    header.append(keyBytes);
+
+    QFile *file = pack->file;
+    const qint64 recordOffset = file->size();
+    if (!file->seek(recordOffset)
+            || file->write(header) != header.size()
+            || (valueOffset && file->write(value) != value.size())) {
+        qWarning() << __PRETTY_FUNCTION__ << file->fileName() << file->errorString();
+        file->resize(recordOffset);
+        return false;
+    }
+    file->flush();
+
+    if (valueOffset) *valueOffset = recordOffset + header.size();
+    return true;
+}
+
+QByteArray IndexedCache::readValue(Entry *entry) {
+    QFile *file = entry->pack->file;
+    if (!file->seek(entry->offset)) return QByteArray();
+    return file->read(entry->size);
+}
+
+void IndexedCache::link(Entry *entry) {
+    entry->prev = lruTail;
+    entry->next = 0;
+    if (lruTail) lruTail->next = entry;
+    else lruHead = entry;
+    lruTail = entry;
+}
+
+void IndexedCache::unlink(Entry *entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else if (lruHead == entry) lruHead = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else if (lruTail == entry) lruTail = entry->prev;
+    entry->prev = entry->next = 0;
+}
+
+void IndexedCache::touch(Entry *entry) {
+    if (entry == lruTail) return;
+    unlink(entry);
+    link(entry);
+}
+
+void IndexedCache::remove(Entry *entry, bool writeTombstone) {
+    if (writeTombstone && !packs.isEmpty())
+        writeRecord(packs.last(), entry->key, QByteArray(), 0);
+
+    Pack *pack = entry->pack;
+    index.remove(entry->key);
+    unlink(entry);
+    pack->entries.remove(entry);
+    pack->liveBytes -= entry->size;
+    size -= entry->size;
+    delete entry;
+
+    if (pack->entries.isEmpty()) dropEmptyPacks();
+}
+
+bool IndexedCache::isExpired(const Entry *entry) const {
+    if (maxSeconds == 0) return false;
+    return QDateTime::currentDateTime().toTime_t() - entry->created >= maxSeconds;
+}
+
+void IndexedCache::expire() {
+    const qint64 goal = (maxSize * 9) / 10;
+    int removed = 0;
+    while (lruHead && size > goal) {
+        remove(lruHead);
+        ++removed;
+    }
+#ifndef QT_NO_DEBUG_OUTPUT
+    debugStats();
+    qDebug() << "Removed:" << removed << "Kept:" << index.size() << "New Size:" << size;
+#endif
+}
+
+void IndexedCache::maybeStartCompaction() {
+    Pack *pack = packs.last();
+    const qint64 fileSize = pack->file->size();
+    if (fileSize < minCompactionSize) return;
+    if (fileSize - pack->liveBytes < pack->liveBytes) return;
+
+    qDebug() << "IndexedCache: compacting" << name << fileSize << "bytes" << pack->liveBytes << "live";
+    openPack(pack->generation + 1);
+}
+
+void IndexedCache::compactStep() {
+    Pack *target = packs.last();
+    Pack *source = packs.first();
+    if (source == target) return;
+
+    int moved = 0;
+    QSet<Entry*>::iterator i = source->entries.begin();
+    while (i != source->entries.end() && moved < compactionBatch) {
+        Entry *entry = *i;
+        i = source->entries.erase(i);
+        source->liveBytes -= entry->size;
+
+        QByteArray bytes;
+        qint64 offset;
+        if (isExpired(entry)
+                || (bytes = readValue(entry)).size() != entry->size
+                || !writeRecord(target, entry->key, bytes, entry->created, &offset)) {
+            // Nothing to carry over, the source pack is about to go anyway
+            index.remove(entry->key);
+            unlink(entry);
+            size -= entry->size;
+            delete entry;
+        } else {
+            entry->pack = target;
+            entry->offset = offset;
+            target->entries.insert(entry);
+            target->liveBytes += entry->size;
+        }
+        ++moved;
+    }
+
+    if (source->entries.isEmpty()) {
+        dropEmptyPacks();
+        qDebug() << "IndexedCache: compacted" << name << target->file->size() << "bytes";
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef INDEXEDCACHE_H
+#define INDEXEDCACHE_H
+
+#include "localcache.h"
+
+/**
+ * @brief LocalCache backend storing all entries in append-only pack files.
+ *
+ * An in-memory index maps keys to their location in a pack file so lookups
+ * never hit filesystem metadata. Eviction is LRU by access time and dead
+ * records are reclaimed by incrementally copying live entries to a new pack.
+ */
+class IndexedCache : public LocalCache {
+
+public:
+    IndexedCache(const QString &name);
+    ~IndexedCache();
+
+    bool isCached(const QString &key);
+    QByteArray value(const QString &key);
+    void insert(const QString &key, const QByteArray &value);
+    bool clear();
+
+private:
+    struct Pack;
+
+    struct Entry {
+        Entry() : pack(0), offset(0), size(0), created(0), prev(0), next(0) { }
+        QString key;
+        Pack *pack;
+        qint64 offset;
+        int size;
+        uint created;
+        // LRU list, the head is the least recently used entry
+        Entry *prev;
+        Entry *next;
+    };
+
+    struct Pack {
+        Pack() : file(0), generation(0), liveBytes(0) { }
+        QFile *file;
+        int generation;
+        qint64 liveBytes;
+        QSet<Entry*> entries;
+    };
+
+    void load();
+    void loadPack(Pack *pack);
+    Pack *openPack(int generation);
+    void dropPack(Pack *pack);
+    void dropEmptyPacks();
+    bool writeRecord(Pack *pack, const QString &key, const QByteArray &value,
+                     uint created, qint64 *valueOffset = 0);
+    QByteArray readValue(Entry *entry);
+
+    void link(Entry *entry);
+    void unlink(Entry *entry);
+    void touch(Entry *entry);
+    void remove(Entry *entry, bool writeTombstone = true);
+    bool isExpired(const Entry *entry) const;
+
+    void expire();
+    void maybeStartCompaction();
+    void compactStep();
+
+    bool loaded;
+    QHash<QString, Entry*> index;
+    QList<Pack*> packs;
+    Entry *lruHead;
+    Entry *lruTail;
+
+};
+
+#endif // INDEXEDCACHE_H
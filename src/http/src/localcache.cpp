@@ -1,10 +1,13 @@
 #include "localcache.h"
+#include "indexedcache.h"
 
-LocalCache *LocalCache::instance(const QString &name) {
+LocalCache *LocalCache::instance(const QString &name, Backend backend) {
     static QHash<QString, LocalCache*> instances;
     QHash<QString, LocalCache*>::const_iterator i = instances.constFind(name);
     if (i != instances.constEnd()) return i.value();
-    LocalCache *instance = new LocalCache(name);
+    LocalCache *instance = 0;
+    if (backend == IndexedBackend) instance = new IndexedCache(name);
+    else instance = new LocalCache(name);
     instances.insert(name, instance);
     return instance;
 }
@@ -13,8 +16,9 @@ LocalCache::LocalCache(const QString &name) : name(name),
     maxSeconds(86400*30),
     maxSize(1024*1024*100),
     size(0),
+    insertCount(0),
     expiring(false),
-    insertCount(0) {
+    memory(0) {
     directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') +
             name + QLatin1Char('/');
 #ifndef QT_NO_DEBUG_OUTPUT
@@ -36,7 +40,38 @@ QString LocalCache::hash(const QString &s) {
     return h.at(0) + QLatin1Char('/') + h.at(1) + QLatin1Char('/') + h.mid(2);
 }
 
+void LocalCache::setMaxMemorySize(uint value) {
+    QMutexLocker locker(&memoryMutex);
+    memory.setMaxCost(value);
+}
+
+QByteArray LocalCache::memoryValue(const QString &key) {
+    QMutexLocker locker(&memoryMutex);
+    MemoryEntry *entry = memory.object(key);
+    if (!entry) return QByteArray();
+    if (maxSeconds > 0 && QDateTime::currentDateTime().toTime_t() - entry->created >= maxSeconds) {
+        memory.remove(key);
+        return QByteArray();
+    }
+    return entry->bytes;
+}
+
+void LocalCache::memoryInsert(const QString &key, const QByteArray &value) {
+    QMutexLocker locker(&memoryMutex);
+    if (value.size() > memory.maxCost()) return;
+    MemoryEntry *entry = new MemoryEntry;
+    entry->bytes = value;
+    entry->created = QDateTime::currentDateTime().toTime_t();
+    memory.insert(key, entry, value.size());
+}
+
+void LocalCache::clearMemory() {
+    QMutexLocker locker(&memoryMutex);
+    memory.clear();
+}
+
 bool LocalCache::isCached(const QString &key) {
+    QMutexLocker locker(&mutex);
     QString path = cachePath(key);
     bool cached = (QFile::exists(path) &&
                    (maxSeconds == 0 ||
@@ -48,6 +83,7 @@ bool LocalCache::isCached(const QString &key) {
 }
 
 QByteArray LocalCache::value(const QString &key) {
+    QMutexLocker locker(&mutex);
     QString path = cachePath(key);
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -64,6 +100,7 @@ QByteArray LocalCache::value(const QString &key) {
 }
 
 void LocalCache::insert(const QString &key, const QByteArray &value) {
+    QMutexLocker locker(&mutex);
     QString path = cachePath(key);
     QFileInfo info(path);
     if (!info.exists())
@@ -84,6 +121,8 @@ void LocalCache::insert(const QString &key, const QByteArray &value) {
 }
 
 bool LocalCache::clear() {
+    QMutexLocker locker(&mutex);
+    clearMemory();
 #ifndef QT_NO_DEBUG_OUTPUT
     hits = 0;
     misses = 0;
@@ -111,7 +150,6 @@ qint64 LocalCache::expire() {
         QFileInfo info = it.fileInfo();
         cacheItems.insert(info.created(), path);
         totalSize += info.size();
-        qApp->processEvents();
     }
 
     int removedFiles = 0;
@@ -127,7 +165,6 @@ qint64 LocalCache::expire() {
         totalSize -= size;
         ++removedFiles;
         ++i;
-        qApp->processEvents();
     }
 #ifndef QT_NO_DEBUG_OUTPUT
     debugStats();
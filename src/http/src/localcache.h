@@ -4,36 +4,51 @@
 #include <QtCore>
 
 /**
- * @brief Not thread-safe
+ * @brief Thread-safe, CachedHttp calls it from its I/O thread
  */
 class LocalCache {
 
 public:
-    static LocalCache *instance(const QString &name);
-    ~LocalCache();
+    enum Backend {
+        // One file per entry in a hashed directory tree
+        FilesBackend,
+        // Single pack file with an in-memory index, see IndexedCache
+        IndexedBackend
+    };
+
+    static LocalCache *instance(const QString &name, Backend backend = FilesBackend);
+    virtual ~LocalCache();
     static QString hash(const QString &s);
 
     void setMaxSeconds(uint value) { maxSeconds = value; }
     void setMaxSize(uint value) { maxSize = value; }
-    bool isCached(const QString &key);
-    QByteArray value(const QString &key);
-    void insert(const QString &key, const QByteArray &value);
-    bool clear();
+    void setMaxMemorySize(uint value);
+    virtual bool isCached(const QString &key);
+    virtual QByteArray value(const QString &key);
+    virtual void insert(const QString &key, const QByteArray &value);
+    virtual bool clear();
 
-private:
+    /**
+     * In-memory tier in front of the disk, bounded by setMaxMemorySize().
+     * Values are implicitly shared so hits are never copied.
+     * Returns a null QByteArray when key is not in memory.
+     */
+    QByteArray memoryValue(const QString &key);
+    void memoryInsert(const QString &key, const QByteArray &value);
+
+protected:
     LocalCache(const QString &name);
-    QString cachePath(const QString &key) const;
-    qint64 expire();
+    void clearMemory();
 #ifndef QT_NO_DEBUG_OUTPUT
     void debugStats();
 #endif
 
+    QMutex mutex;
     QString name;
     QString directory;
     uint maxSeconds;
     qint64 maxSize;
     qint64 size;
-    bool expiring;
     uint insertCount;
 
 #ifndef QT_NO_DEBUG_OUTPUT
@@ -41,6 +56,21 @@ private:
     uint misses;
 #endif
 
+private:
+    struct MemoryEntry {
+        QByteArray bytes;
+        uint created;
+    };
+
+    QString cachePath(const QString &key) const;
+    qint64 expire();
+
+    bool expiring;
+
+    // guards memory only, so memory hits never wait for disk I/O
+    QMutex memoryMutex;
+    QCache<QString, MemoryEntry> memory;
+
 };
 
 #endif // LOCALCACHE_H
@@ -1,58 +1,49 @@
 #include "throttledhttp.h"
 
-namespace {
+ThrottledHttp::ThrottledHttp(Http &http) :
+    queue(new ThrottledHttpQueue(http)) { }
 
-QElapsedTimer initElapsedTimer() {
-    QElapsedTimer timer;
-    timer.start();
-    return timer;
+ThrottledHttp::~ThrottledHttp() {
+    queue->deleteLater();
 }
 
+void ThrottledHttp::setMilliseconds(int milliseconds) {
+    queue->setMilliseconds(milliseconds);
 }
 
-ThrottledHttp::ThrottledHttp(Http &http) : http(http),
-    elapsedTimer(initElapsedTimer()) { }
+void ThrottledHttp::setBurst(int burst) {
+    queue->setBurst(burst);
+}
+
+void ThrottledHttp::setHostLimit(const QString &host, int milliseconds, int burst) {
+    queue->setHostLimit(host, milliseconds, burst);
+}
 
 QObject* ThrottledHttp::request(const HttpRequest &req) {
-    return new ThrottledHttpReply(http, req, milliseconds, elapsedTimer);
+    ThrottledHttpReply *reply = new ThrottledHttpReply(queue->getHttp(), req, queue);
+    queue->enqueue(reply);
+    return reply;
+}
+
+bool ThrottledHttp::promote(QObject *reply, HttpRequest::Priority priority) {
+    ThrottledHttpReply *throttledReply = qobject_cast<ThrottledHttpReply*>(reply);
+    if (!throttledReply) return false;
+    queue->promote(throttledReply, priority);
+    return true;
 }
 
-ThrottledHttpReply::ThrottledHttpReply(Http &http,
-                                       const HttpRequest &req,
-                                       int milliseconds,
-                                       QElapsedTimer &elapsedTimer) :
+ThrottledHttpReply::ThrottledHttpReply(Http &http, const HttpRequest &req,
+                                       ThrottledHttpQueue *queue) :
     http(http),
     req(req),
-    milliseconds(milliseconds),
-    elapsedTimer(elapsedTimer),
-    timer(0) {
-    checkElapsed();
-}
-
-void ThrottledHttpReply::checkElapsed() {
-    /*
-    static QMutex mutex;
-    QMutexLocker locker(&mutex);
-    */
-
-    const qint64 elapsedSinceLastRequest = elapsedTimer.elapsed();
-    if (elapsedSinceLastRequest < milliseconds) {
-        if (!timer) {
-            timer = new QTimer(this);
-            timer->setSingleShot(true);
-            timer->setTimerType(Qt::PreciseTimer);
-            connect(timer, SIGNAL(timeout()), SLOT(checkElapsed()));
-        }
-        qDebug() << "Throttling" << req.url << QString("%1ms").arg(milliseconds - elapsedSinceLastRequest);
-        timer->setInterval(milliseconds - elapsedSinceLastRequest);
-        timer->start();
-        return;
-    }
-    elapsedTimer.start();
-    doRequest();
+    queue(queue) { }
+
+ThrottledHttpReply::~ThrottledHttpReply() {
+    if (queue) queue->remove(this);
 }
 
 void ThrottledHttpReply::doRequest() {
+    queue = 0;
     QObject* reply = http.request(req);
     connect(reply, SIGNAL(data(QByteArray)), SIGNAL(data(QByteArray)));
     connect(reply, SIGNAL(error(QString)), SIGNAL(error(QString)));
@@ -61,3 +52,104 @@ void ThrottledHttpReply::doRequest() {
     // this will cause the deletion of this object once the request is finished
     setParent(reply);
 }
+
+ThrottledHttpQueue::ThrottledHttpQueue(Http &http) : http(http),
+    milliseconds(0),
+    burst(1) {
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, SIGNAL(timeout()), SLOT(dispatch()));
+    clock.start();
+}
+
+void ThrottledHttpQueue::setHostLimit(const QString &host, int milliseconds, int burst) {
+    hostLimits.insert(host, qMakePair(milliseconds, burst));
+    buckets.remove(host);
+}
+
+void ThrottledHttpQueue::enqueue(ThrottledHttpReply *reply) {
+    int priority = qBound(0, int(reply->request().priority), HttpRequest::PriorityCount - 1);
+    pending[priority].append(reply);
+    dispatch();
+}
+
+void ThrottledHttpQueue::remove(ThrottledHttpReply *reply) {
+    for (int i = 0; i < HttpRequest::PriorityCount; ++i)
+        if (pending[i].removeOne(reply)) return;
+}
+
+void ThrottledHttpQueue::promote(ThrottledHttpReply *reply, HttpRequest::Priority priority) {
+    const int target = qBound(0, int(priority), HttpRequest::PriorityCount - 1);
+    // dispatched replies and the ones already queued higher are left alone
+    for (int i = 0; i < target; ++i) {
+        if (!pending[i].removeOne(reply)) continue;
+        reply->setPriority(priority);
+        pending[target].append(reply);
+        dispatch();
+        return;
+    }
+}
+
+ThrottledHttpQueue::Bucket &ThrottledHttpQueue::bucketFor(const QString &host) {
+    QHash<QString, Bucket>::iterator i = buckets.find(host);
+    if (i != buckets.end()) return i.value();
+
+    Bucket bucket;
+    QHash<QString, QPair<int, int> >::const_iterator limit = hostLimits.constFind(host);
+    if (limit != hostLimits.constEnd()) {
+        bucket.milliseconds = limit.value().first;
+        bucket.burst = qMax(1, limit.value().second);
+    } else {
+        bucket.milliseconds = milliseconds;
+        bucket.burst = qMax(1, burst);
+    }
+    bucket.tokens = bucket.burst;
+    bucket.lastRefill = clock.elapsed();
+    return buckets.insert(host, bucket).value();
+}
+
+void ThrottledHttpQueue::refill(Bucket &bucket, qint64 now) {
+    if (bucket.milliseconds <= 0) {
+        bucket.tokens = bucket.burst;
+    } else {
+        bucket.tokens = qMin<double>(bucket.burst,
+                                     bucket.tokens + double(now - bucket.lastRefill) / bucket.milliseconds);
+    }
+    bucket.lastRefill = now;
+}
+
+void ThrottledHttpQueue::dispatch() {
+    const qint64 now = clock.elapsed();
+    QSet<QString> refilled;
+    qint64 wait = -1;
+
+    // Higher priorities first, so they get the tokens of a shared host
+    for (int priority = HttpRequest::PriorityCount - 1; priority >= 0; --priority) {
+        QList<ThrottledHttpReply*> &queue = pending[priority];
+        QList<ThrottledHttpReply*>::iterator i = queue.begin();
+        while (i != queue.end()) {
+            ThrottledHttpReply *reply = *i;
+            const QString host = reply->request().url.host();
+            Bucket &bucket = bucketFor(host);
+            if (!refilled.contains(host)) {
+                refill(bucket, now);
+                refilled.insert(host);
+            }
+
+            if (bucket.tokens >= 1.) {
+                bucket.tokens -= 1.;
+                i = queue.erase(i);
+                reply->doRequest();
+                continue;
+            }
+
+            const qint64 bucketWait = qCeil((1. - bucket.tokens) * bucket.milliseconds);
+            if (wait == -1 || bucketWait < wait) wait = bucketWait;
+            qDebug() << "Throttling" << reply->request().url << QString("%1ms").arg(bucketWait);
+            ++i;
+        }
+    }
+
+    if (wait >= 0) timer->start(int(qMax<qint64>(wait, 1)));
+}
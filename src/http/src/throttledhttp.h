@@ -5,17 +5,27 @@
 #include <QtNetwork>
 #include "http.h"
 
+class ThrottledHttpQueue;
+
+/**
+ * @brief Rate limits requests with a token bucket per host.
+ *
+ * Each bucket gains one token every milliseconds() up to burst() tokens.
+ * Pending requests are dispatched by priority, then in submission order.
+ */
 class ThrottledHttp : public Http {
 
 public:
     ThrottledHttp(Http &http = Http::instance());
-    void setMilliseconds(int milliseconds) { this->milliseconds = milliseconds; }
+    ~ThrottledHttp();
+    void setMilliseconds(int milliseconds);
+    void setBurst(int burst);
+    void setHostLimit(const QString &host, int milliseconds, int burst);
     QObject* request(const HttpRequest &req);
+    bool promote(QObject *reply, HttpRequest::Priority priority);
 
 private:
-    Http &http;
-    int milliseconds;
-    QElapsedTimer elapsedTimer;
+    ThrottledHttpQueue *queue;
 
 };
 
@@ -24,24 +34,62 @@ class ThrottledHttpReply : public HttpReply {
     Q_OBJECT
 
 public:
-    ThrottledHttpReply(Http &http,
-                       const HttpRequest &req,
-                       int milliseconds,
-                       QElapsedTimer &elapsedTimer);
+    ThrottledHttpReply(Http &http, const HttpRequest &req, ThrottledHttpQueue *queue);
+    ~ThrottledHttpReply();
     QUrl url() const { return req.url; }
     int statusCode() const { return 200; }
     QByteArray body() const { return QByteArray(); }
+    const HttpRequest &request() const { return req; }
+    void setPriority(HttpRequest::Priority priority) { req.priority = priority; }
+    void doRequest();
+
+private:
+    Http &http;
+    HttpRequest req;
+    ThrottledHttpQueue *queue;
+
+};
+
+class ThrottledHttpQueue : public QObject {
+
+    Q_OBJECT
+
+public:
+    ThrottledHttpQueue(Http &http);
+    Http &getHttp() { return http; }
+
+    void setMilliseconds(int value) { milliseconds = value; }
+    void setBurst(int value) { burst = value; }
+    void setHostLimit(const QString &host, int milliseconds, int burst);
+
+    void enqueue(ThrottledHttpReply *reply);
+    void remove(ThrottledHttpReply *reply);
+    void promote(ThrottledHttpReply *reply, HttpRequest::Priority priority);
 
 private slots:
-    void checkElapsed();
+    void dispatch();
 
 private:
-    void doRequest();
+    struct Bucket {
+        Bucket() : milliseconds(0), burst(1), tokens(1), lastRefill(0) { }
+        int milliseconds;
+        int burst;
+        double tokens;
+        qint64 lastRefill;
+    };
+
+    Bucket &bucketFor(const QString &host);
+    void refill(Bucket &bucket, qint64 now);
+
     Http &http;
-    HttpRequest req;
     int milliseconds;
-    QElapsedTimer &elapsedTimer;
+    int burst;
+    QHash<QString, Bucket> buckets;
+    QHash<QString, QPair<int, int> > hostLimits;
+    // one FIFO per HttpRequest::Priority
+    QList<ThrottledHttpReply*> pending[HttpRequest::PriorityCount];
     QTimer *timer;
+    QElapsedTimer clock;
 
 };
 
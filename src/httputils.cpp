@@ -21,6 +21,7 @@ Http &HttpUtils::cached() {
         http->addRequestHeader("User-Agent", userAgent());
 
         CachedHttp *cachedHttp = new CachedHttp(*http, "http");
+        cachedHttp->setMaxMemorySize(1024 * 1024 * 4);
 
         return cachedHttp;
     }();
@@ -31,17 +32,33 @@ Http &HttpUtils::yt() {
     static Http *h = [] {
         Http *http = new Http;
         http->addRequestHeader("User-Agent", stealthUserAgent());
+        // API calls, thumbnails and video info pages all go through here
+        http->setHttp2Allowed(true);
 
-        CachedHttp *cachedHttp = new CachedHttp(*http, "yt");
+        // Generous enough to never slow down a single view,
+        // its main job is letting interactive requests jump the queue
+        ThrottledHttp *throttledHttp = new ThrottledHttp(*http);
+        throttledHttp->setMilliseconds(25);
+        throttledHttp->setBurst(20);
+
+        CachedHttp *cachedHttp = new CachedHttp(*throttledHttp, "yt", LocalCache::IndexedBackend);
         cachedHttp->setMaxSeconds(3600);
+        cachedHttp->setMaxMemorySize(1024 * 1024 * 16);
 
         return cachedHttp;
     }();
     return *h;
 }
 
+void HttpUtils::preconnect() {
+    const QStringList hosts = QStringList() << "www.googleapis.com" << "www.youtube.com"
+                                            << "i.ytimg.com";
+    foreach (const QString &host, hosts)
+        Http::preconnect(host, true);
+}
+
 void HttpUtils::clearCaches() {
-    LocalCache::instance("yt")->clear();
+    LocalCache::instance("yt", LocalCache::IndexedBackend)->clear();
     LocalCache::instance("http")->clear();
 }
 
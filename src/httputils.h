@@ -11,6 +11,8 @@ public:
     static Http &notCached();
     static Http &cached();
     static Http &yt();
+    // warms up the connections yt() is going to need first
+    static void preconnect();
     static void clearCaches();
 
     static const QByteArray &userAgent();
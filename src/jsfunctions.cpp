@@ -49,10 +49,15 @@ JsFunctions::JsFunctions(const QString &url, QObject *parent) : QObject(parent),
 
 void JsFunctions::parseJs(const QString &js) {
     if (js.isEmpty()) return;
+    // a fresh download is usually what we already have
+    if (engine && js == currentJs) return;
     // qDebug() << "Parsing" << js;
     if (engine) delete engine;
     engine = new QJSEngine(this);
     engine->evaluate(js);
+    currentJs = js;
+    functions.clear();
+    results.clear();
     emit ready();
 }
 
@@ -122,40 +127,76 @@ QStringList JsFunctions::stringArray(const QString &js) {
     return items;
 }
 
+QJSValue JsFunctions::call(const QString &name, const QJSValueList &args) {
+    if (!engine) return QString();
+    QHash<QString, QJSValue>::const_iterator i = functions.constFind(name);
+    if (i == functions.constEnd()) {
+        QJSValue function = engine->globalObject().property(name);
+        if (!function.isCallable()) {
+            qWarning() << "Not a function" << name;
+            return QString();
+        }
+        i = functions.insert(name, function);
+    }
+
+    QJSValue value = i.value().call(args);
+    if (value.isUndefined())
+        qWarning() << "Undefined result for" << name << args.size();
+    if (value.isError())
+        qWarning() << "Error in" << name << value.toString();
+    return value;
+}
+
+QString JsFunctions::callString(const QString &name, const QString &arg) {
+    const QString key = name + QLatin1Char('\n') + arg;
+    QHash<QString, QString>::const_iterator i = results.constFind(key);
+    if (i != results.constEnd()) return i.value();
+
+    QJSValueList args;
+    if (!arg.isNull()) args << arg;
+    QJSValue value = call(name, args);
+    if (!engine || value.isUndefined() || value.isError()) return value.toString();
+    const QString result = value.toString();
+    // signatures are all different, don't let them pile up
+    if (results.size() > 1000) results.clear();
+    results.insert(key, result);
+    return result;
+}
+
 QString JsFunctions::decryptSignature(const QString &s) {
-    return string("decryptSignature('" + s + "')");
+    return callString("decryptSignature", s);
 }
 
 QString JsFunctions::decryptAgeSignature(const QString &s) {
-    return string("decryptAgeSignature('" + s + "')");
+    return callString("decryptAgeSignature", s);
 }
 
 QString JsFunctions::videoIdRE() {
-    return string("videoIdRE()");
+    return callString("videoIdRE");
 }
 
 QString JsFunctions::videoTokenRE() {
-    return string("videoTokenRE()");
+    return callString("videoTokenRE");
 }
 
 QString JsFunctions::videoInfoFmtMapRE() {
-    return string("videoInfoFmtMapRE()");
+    return callString("videoInfoFmtMapRE");
 }
 
 QString JsFunctions::webPageFmtMapRE() {
-    return string("webPageFmtMapRE()");
+    return callString("webPageFmtMapRE");
 }
 
 QString JsFunctions::ageGateRE() {
-    return string("ageGateRE()");
+    return callString("ageGateRE");
 }
 
 QString JsFunctions::jsPlayerRE() {
-    return string("jsPlayerRE()");
+    return callString("jsPlayerRE");
 }
 
 QString JsFunctions::signatureFunctionNameRE() {
-    return string("signatureFunctionNameRE()");
+    return callString("signatureFunctionNameRE");
 }
 
 QStringList JsFunctions::apiKeys() {
@@ -36,6 +36,8 @@ public:
     QJSValue evaluate(const QString &js);
     QString string(const QString &js);
     QStringList stringArray(const QString &js);
+    // calls a global function by name, the handle is looked up once per functions.js
+    QJSValue call(const QString &name, const QJSValueList &args = QJSValueList());
 
     // Specialized functions
     // TODO move to subclass
@@ -63,8 +65,15 @@ private:
     void loadJs();
     void parseJs(const QString &js);
 
+    QString callString(const QString &name, const QString &arg = QString());
+
     QString url;
     QJSEngine *engine;
+    // the source currently loaded in engine
+    QString currentJs;
+    QHash<QString, QJSValue> functions;
+    // results of the deterministic calls, valid until functions.js changes
+    QHash<QString, QString> results;
 };
 
 #endif // JSFUNCTIONS_H
@@ -0,0 +1,28 @@
+#include "jsonparsetask.h"
+
+JsonParseTask::JsonParseTask(const QByteArray &bytes) : bytes(bytes) {
+    // deleted via deleteLater() once finished() is out
+    setAutoDelete(false);
+}
+
+void JsonParseTask::start() {
+    threadPool()->start(this);
+}
+
+QThreadPool *JsonParseTask::threadPool() {
+    static QThreadPool *pool = [] {
+        QThreadPool *pool = new QThreadPool();
+        // a couple of pages at once is all the app ever has in flight
+        pool->setMaxThreadCount(2);
+        return pool;
+    }();
+    return pool;
+}
+
+void JsonParseTask::run() {
+    parse(bytes);
+    bytes.clear();
+    // both are delivered in our own thread, in this order
+    emit finished();
+    deleteLater();
+}
@@ -0,0 +1,52 @@
+#ifndef JSONPARSETASK_H
+#define JSONPARSETASK_H
+
+#include <QtCore>
+
+/**
+ * @brief Parses an API response on a small thread pool, off the GUI thread.
+ *
+ * Subclasses implement parse() and keep what they extract as members.
+ * finished() is queued to the thread that created the task, which deletes
+ * itself right after, so receivers read the results via sender() and must
+ * not keep the pointer. Receivers deleted in the meantime simply miss it.
+ */
+class JsonParseTask : public QObject, public QRunnable {
+
+    Q_OBJECT
+
+public:
+    JsonParseTask(const QByteArray &bytes);
+    void start();
+
+    static QThreadPool *threadPool();
+
+signals:
+    void finished();
+
+protected:
+    // runs on a pool thread
+    virtual void parse(const QByteArray &bytes) = 0;
+
+private:
+    void run();
+
+    QByteArray bytes;
+
+};
+
+class JsonDocumentParseTask : public JsonParseTask {
+
+public:
+    JsonDocumentParseTask(const QByteArray &bytes) : JsonParseTask(bytes) { }
+    const QJsonDocument &document() const { return doc; }
+
+protected:
+    void parse(const QByteArray &bytes) { doc = QJsonDocument::fromJson(bytes); }
+
+private:
+    QJsonDocument doc;
+
+};
+
+#endif // JSONPARSETASK_H
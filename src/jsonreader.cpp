@@ -0,0 +1,245 @@
+#include "jsonreader.h"
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDelimiter(char c) {
+    return c == ',' || c == '}' || c == ']' || isSpace(c);
+}
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}
+
+JsonReader::JsonReader(const QByteArray &bytes) :
+    bytes(bytes),
+    p(this->bytes.constData()),
+    end(p + this->bytes.size()),
+    error(false) { }
+
+void JsonReader::fail() {
+    error = true;
+    p = end;
+}
+
+void JsonReader::skipSpace() {
+    while (p < end && isSpace(*p)) ++p;
+}
+
+bool JsonReader::expect(char c) {
+    skipSpace();
+    if (p < end && *p == c) {
+        ++p;
+        return true;
+    }
+    fail();
+    return false;
+}
+
+JsonReader::Type JsonReader::peek() {
+    skipSpace();
+    if (p >= end) return InvalidType;
+    switch (*p) {
+    case '{': return ObjectType;
+    case '[': return ArrayType;
+    case '"': return StringType;
+    case 't':
+    case 'f': return BoolType;
+    case 'n': return NullType;
+    default:
+        if (*p == '-' || (*p >= '0' && *p <= '9')) return NumberType;
+        return InvalidType;
+    }
+}
+
+bool JsonReader::beginObject() {
+    return expect('{');
+}
+
+bool JsonReader::nextKey(QByteArray &key) {
+    if (error) return false;
+    skipSpace();
+    if (p < end && *p == ',') {
+        ++p;
+        skipSpace();
+    }
+    if (p < end && *p == '}') {
+        ++p;
+        return false;
+    }
+    const char *start = p + 1;
+    if (p >= end || *p != '"' || !skipString()) {
+        fail();
+        return false;
+    }
+    key = QByteArray::fromRawData(start, p - start - 1);
+    return expect(':');
+}
+
+bool JsonReader::beginArray() {
+    return expect('[');
+}
+
+bool JsonReader::nextElement() {
+    if (error) return false;
+    skipSpace();
+    if (p < end && *p == ',') {
+        ++p;
+        skipSpace();
+    }
+    if (p < end && *p == ']') {
+        ++p;
+        return false;
+    }
+    if (p >= end) {
+        fail();
+        return false;
+    }
+    return true;
+}
+
+bool JsonReader::skipString() {
+    // p is on the opening quote
+    ++p;
+    while (p < end) {
+        const char c = *p;
+        if (c == '\\') p += 2;
+        else if (c == '"') {
+            ++p;
+            return true;
+        } else ++p;
+    }
+    fail();
+    return false;
+}
+
+QString JsonReader::readString() {
+    const Type type = peek();
+    if (type == NullType) {
+        skipValue();
+        return QString();
+    }
+    if (type != StringType) {
+        fail();
+        return QString();
+    }
+
+    const char *start = ++p;
+    const char *run = start;
+    QString s;
+    while (p < end) {
+        const char c = *p;
+        if (c == '"') {
+            // common case, no escapes at all
+            if (run == start) {
+                ++p;
+                return QString::fromUtf8(start, p - start - 1);
+            }
+            s += QString::fromUtf8(run, p - run);
+            ++p;
+            return s;
+        }
+        if (c != '\\') {
+            ++p;
+            continue;
+        }
+
+        s += QString::fromUtf8(run, p - run);
+        if (p + 1 >= end) break;
+        const char e = p[1];
+        p += 2;
+        switch (e) {
+        case '"': s += QLatin1Char('"'); break;
+        case '\\': s += QLatin1Char('\\'); break;
+        case '/': s += QLatin1Char('/'); break;
+        case 'b': s += QLatin1Char('\b'); break;
+        case 'f': s += QLatin1Char('\f'); break;
+        case 'n': s += QLatin1Char('\n'); break;
+        case 'r': s += QLatin1Char('\r'); break;
+        case 't': s += QLatin1Char('\t'); break;
+        case 'u': {
+            if (end - p < 4) {
+                fail();
+                return QString();
+            }
+            ushort unit = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int value = hexValue(p[i]);
+                if (value < 0) {
+                    fail();
+                    return QString();
+                }
+                unit = (unit << 4) | value;
+            }
+            // surrogate pairs come as two escapes and combine in UTF-16
+            s += QChar(unit);
+            p += 4;
+            break;
+        }
+        default:
+            fail();
+            return QString();
+        }
+        run = p;
+    }
+    fail();
+    return QString();
+}
+
+QString JsonReader::readScalar() {
+    switch (peek()) {
+    case StringType:
+        return readString();
+    case NullType:
+        skipValue();
+        return QString();
+    case NumberType:
+    case BoolType: {
+        const char *start = p;
+        while (p < end && !isDelimiter(*p)) ++p;
+        return QString::fromLatin1(start, p - start);
+    }
+    default:
+        fail();
+        return QString();
+    }
+}
+
+void JsonReader::skipValue() {
+    switch (peek()) {
+    case StringType:
+        skipString();
+        break;
+    case ObjectType:
+    case ArrayType: {
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') {
+                if (!skipString()) return;
+                continue;
+            }
+            ++p;
+            if (c == '{' || c == '[') ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0) return;
+        }
+        fail();
+        break;
+    }
+    case NumberType:
+    case BoolType:
+    case NullType:
+        while (p < end && !isDelimiter(*p)) ++p;
+        break;
+    default:
+        fail();
+    }
+}
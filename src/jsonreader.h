@@ -0,0 +1,65 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QtCore>
+
+/**
+ * @brief Forward-only pull reader over UTF-8 JSON.
+ *
+ * Walks the input without building a document, so callers can pick the
+ * few fields they need and skipValue() everything else.
+ * Any malformed input sets hasError() and makes further reads fail.
+ *
+ *     reader.beginObject();
+ *     while (reader.nextKey(key)) {
+ *         if (key == "title") title = reader.readString();
+ *         else reader.skipValue();
+ *     }
+ */
+class JsonReader {
+
+public:
+    enum Type {
+        InvalidType,
+        NullType,
+        BoolType,
+        NumberType,
+        StringType,
+        ArrayType,
+        ObjectType
+    };
+
+    JsonReader(const QByteArray &bytes);
+
+    bool hasError() const { return error; }
+    // type of the next value, without consuming it
+    Type peek();
+
+    bool beginObject();
+    // false once the object is closed. Keys are returned raw, without unescaping.
+    bool nextKey(QByteArray &key);
+
+    bool beginArray();
+    // false once the array is closed
+    bool nextElement();
+
+    QString readString();
+    // any scalar as a string, null reads as an empty string
+    QString readScalar();
+    void skipValue();
+
+private:
+    void skipSpace();
+    bool expect(char c);
+    bool skipString();
+    void fail();
+
+    // keeps the data alive for p and the raw keys
+    QByteArray bytes;
+    const char *p;
+    const char *end;
+    bool error;
+
+};
+
+#endif // JSONREADER_H
@@ -27,6 +27,7 @@ $END_LICENSE */
 #include "spacer.h"
 #include "constants.h"
 #include "iconutils.h"
+#include "video.h"
 #include "videodefinition.h"
 #include "fontutils.h"
 #include "globalshortcuts.h"
@@ -164,6 +165,9 @@ MainWindow::MainWindow() :
 }
 
 void MainWindow::lazyInit() {
+    // DNS, TCP and TLS happen while the rest of the UI gets ready
+    HttpUtils::preconnect();
+
 #ifdef APP_PHONON
     initPhonon();
 #endif
@@ -1051,6 +1055,7 @@ void MainWindow::quit() {
     }
     // mediaView->stop();
     Temporary::deleteAll();
+    Video::saveVariantStats();
     ChannelAggregator::instance()->stop();
     ChannelAggregator::instance()->cleanup();
     Database::shutdown();
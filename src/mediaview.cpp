@@ -51,6 +51,7 @@ $END_LICENSE */
 #endif
 #include "datautils.h"
 #include "idle.h"
+#include "streamurlcache.h"
 
 MediaView* MediaView::instance() {
     static MediaView *i = new MediaView();
@@ -60,6 +61,7 @@ MediaView* MediaView::instance() {
 MediaView::MediaView(QWidget *parent) : View(parent)
   , stopped(false)
   , downloadItem(0)
+  , lookAheadItem(0)
   #ifdef APP_SNAPSHOT
   , snapshotSettings(0)
   #endif
@@ -203,8 +205,6 @@ void MediaView::search(SearchParams *searchParams) {
         }
     }
     YTSearch *ytSearch = new YTSearch(searchParams, this);
-    ytSearch->setAsyncDetails(true);
-    connect(ytSearch, SIGNAL(gotDetails()), playlistModel, SLOT(emitDataChanged()));
     setVideoSource(ytSearch);
 }
 
@@ -307,6 +307,9 @@ void MediaView::disappear() {
 
 void MediaView::handleError(const QString &message) {
     qWarning() << __PRETTY_FUNCTION__ << message;
+    // the stream URL may be what failed, don't hand it out again
+    Video *video = playlistModel->activeVideo();
+    if (video) StreamUrlCache::remove(video->id());
 #ifdef APP_PHONON_SEEK
     mediaObject->play();
 #else
@@ -379,6 +382,7 @@ void MediaView::stop() {
         downloadItem = 0;
         currentVideoSize = 0;
     }
+    dropLookAheadItem();
     MainWindow::instance()->getActionMap().value("refine-search")->setChecked(false);
     updateSubscriptionAction(0, false);
 #ifdef APP_ACTIVATION
@@ -517,6 +521,7 @@ void MediaView::gotStreamUrl(QUrl streamUrl) {
 
     // ensure we always have videos ahead
     playlistModel->searchNeeded();
+    lookAhead();
 
     // ensure active item is visible
     int row = playlistModel->activeRow();
@@ -559,9 +564,12 @@ void MediaView::downloadStatusChanged() {
 #ifdef APP_PHONON_SEEK
         MainWindow::instance()->getSeekSlider()->setEnabled(mediaObject->isSeekable());
 #endif
+        // the connection is free now
+        preBufferNext();
         break;
     case Failed:
         // qDebug() << "Failed";
+        StreamUrlCache::remove(downloadItem->getVideo()->id());
         skip();
         break;
     case Idle:
@@ -904,13 +912,28 @@ void MediaView::fullscreen() {
 void MediaView::startDownloading() {
     Video *video = playlistModel->activeVideo();
     if (!video) return;
-    Video *videoCopy = video->clone();
     if (downloadItem) {
         downloadItem->stop();
         delete downloadItem;
+        downloadItem = 0;
+    }
+
+    if (lookAheadItem && lookAheadItem->status() != Failed
+            && lookAheadItem->getVideo()->id() == video->id()) {
+        // it's been buffering while the previous video played
+        qDebug() << "Using look-ahead download for" << video->title();
+        downloadItem = lookAheadItem;
+        lookAheadItem = 0;
+        // the previous video's file can go now
+        Temporary::promoteLookAhead();
+    } else {
+        if (lookAheadItem && lookAheadItem->status() == Failed)
+            StreamUrlCache::remove(lookAheadItem->getVideo()->id());
+        dropLookAheadItem();
+        QString tempFile = Temporary::filename();
+        downloadItem = new DownloadItem(video->clone(), video->getStreamUrl(), tempFile, this);
     }
-    QString tempFile = Temporary::filename();
-    downloadItem = new DownloadItem(videoCopy, video->getStreamUrl(), tempFile, this);
+
     connect(downloadItem, SIGNAL(statusChanged()),
             SLOT(downloadStatusChanged()), Qt::UniqueConnection);
     connect(downloadItem, SIGNAL(bufferProgress(int)),
@@ -920,7 +943,62 @@ void MediaView::startDownloading() {
             SLOT(handleError(QString)), Qt::UniqueConnection);
     connect(downloadItem, SIGNAL(error(QString)),
             SLOT(handleError(QString)), Qt::UniqueConnection);
-    downloadItem->start();
+
+    switch (downloadItem->status()) {
+    case Idle:
+        downloadItem->start();
+        break;
+    case Downloading:
+        // DownloadItem only gets here once its initial buffer is in,
+        // see DownloadItem::downloadProgress()
+        startPlaying();
+        break;
+    case Finished:
+        startPlaying();
+        preBufferNext();
+        break;
+    default:
+        // statusChanged() will tell
+        break;
+    }
+}
+
+void MediaView::lookAhead() {
+    Video *video = playlistModel->videoAt(playlistModel->nextRow());
+    if (!video) return;
+    // served from the stream URL cache once the video becomes active
+    video->loadStreamUrl();
+}
+
+void MediaView::preBufferNext() {
+#ifndef APP_PHONON_SEEK
+    if (stopped || lookAheadItem) return;
+    Video *video = playlistModel->videoAt(playlistModel->nextRow());
+    if (!video) return;
+    connect(video, SIGNAL(gotStreamUrl(QUrl)), SLOT(preBuffer(QUrl)), Qt::UniqueConnection);
+    video->loadStreamUrl();
+#endif
+}
+
+void MediaView::preBuffer(const QUrl &streamUrl) {
+    Video *video = static_cast<Video *>(sender());
+    disconnect(video, SIGNAL(gotStreamUrl(QUrl)), this, SLOT(preBuffer(QUrl)));
+
+    // things may have moved on while the URL was loading
+    if (stopped || lookAheadItem || !streamUrl.isValid()) return;
+    if (video == playlistModel->activeVideo()) return;
+    if (video != playlistModel->videoAt(playlistModel->nextRow())) return;
+
+    qDebug() << "Pre-buffering" << video->title();
+    lookAheadItem = new DownloadItem(video->clone(), streamUrl, Temporary::lookAheadFilename(), this);
+    lookAheadItem->start();
+}
+
+void MediaView::dropLookAheadItem() {
+    if (!lookAheadItem) return;
+    lookAheadItem->stop();
+    delete lookAheadItem;
+    lookAheadItem = 0;
 }
 
 void MediaView::resumeWithNewStreamUrl(const QUrl &streamUrl) {
@@ -1047,7 +1125,6 @@ void MediaView::relatedVideos() {
     if (!video) return;
     YTSingleVideoSource *singleVideoSource = new YTSingleVideoSource();
     singleVideoSource->setVideo(video->clone());
-    singleVideoSource->setAsyncDetails(true);
     setVideoSource(singleVideoSource);
     MainWindow::instance()->getActionMap().value("related-videos")->setEnabled(false);
 }
@@ -128,12 +128,16 @@ private slots:
     qint64 offsetToTime(qint64 offset);
     void startDownloading();
     void resumeWithNewStreamUrl(const QUrl &streamUrl);
+    void preBuffer(const QUrl &streamUrl);
 
 private:
     MediaView(QWidget *parent = 0);
     SearchParams* getSearchParams();
 
     static QRegExp wordRE(const QString &s);
+    void lookAhead();
+    void preBufferNext();
+    void dropLookAheadItem();
 
     QSplitter *splitter;
     SidebarWidget *sidebar;
@@ -157,6 +161,8 @@ private:
 #endif
 
     DownloadItem *downloadItem;
+    // the next video, downloading ahead of time
+    DownloadItem *lookAheadItem;
     QList<VideoSource*> history;
     QList<QAction*> currentVideoActions;
 
@@ -0,0 +1,78 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "pagetokencache.h"
+#include "database.h"
+#include <QtSql>
+
+QString PageTokenCache::chainKey(const QUrl &url) {
+    // The API key may change between sessions, the chain does not.
+    // Page sizes may vary along a chain, tokens are kept by start index.
+    QUrlQuery q(url);
+    q.removeAllQueryItems("pageToken");
+    q.removeAllQueryItems("key");
+    q.removeAllQueryItems("maxResults");
+    QUrl chainUrl = url;
+    chainUrl.setQuery(q);
+    return chainUrl.toString();
+}
+
+QString PageTokenCache::lookup(const QString &chain, int startIndex) {
+    QSqlQuery query = Database::instance().cachedQuery(
+                "select token from page_tokens where chain=? and start_index=?");
+    query.bindValue(0, chain);
+    query.bindValue(1, startIndex);
+    if (!query.exec()) {
+        qWarning() << query.lastQuery() << query.lastError().text();
+        return QString();
+    }
+    if (!query.next()) return QString();
+    const QString token = query.value(0).toString();
+    query.finish();
+    return token;
+}
+
+void PageTokenCache::store(const QString &chain, int startIndex, const QString &token) {
+    if (token.isEmpty()) return;
+    QSqlQuery query = Database::instance().cachedQuery(
+                "insert or replace into page_tokens (chain,start_index,token,stored) "
+                "values (?,?,?,?)");
+    query.bindValue(0, chain);
+    query.bindValue(1, startIndex);
+    query.bindValue(2, token);
+    query.bindValue(3, QDateTime::currentDateTimeUtc().toTime_t());
+    if (!query.exec()) qWarning() << query.lastQuery() << query.lastError().text();
+}
+
+void PageTokenCache::remove(const QString &chain, int startIndex) {
+    QSqlQuery query = Database::instance().cachedQuery(
+                "delete from page_tokens where chain=? and start_index=?");
+    query.bindValue(0, chain);
+    query.bindValue(1, startIndex);
+    if (!query.exec()) qWarning() << query.lastQuery() << query.lastError().text();
+}
+
+void PageTokenCache::prune() {
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    QSqlQuery query(Database::instance().getConnection());
+    query.prepare("delete from page_tokens where stored<?");
+    query.bindValue(0, now - pruneAge);
+    if (!query.exec()) qWarning() << query.lastQuery() << query.lastError().text();
+}
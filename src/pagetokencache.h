@@ -0,0 +1,50 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef PAGETOKENCACHE_H
+#define PAGETOKENCACHE_H
+
+#include <QtCore>
+
+/**
+  * Page tokens of API listings, stored in the database.
+  * A chain is a listing request without its page token, tokens are kept
+  * by the start index of the page they lead to. This lets a new source
+  * continue where an earlier one, or an earlier session, left off.
+  */
+class PageTokenCache {
+
+public:
+    // tokens are used until the API rejects them, these are just forgotten
+    static const uint pruneAge = 7 * 24 * 60 * 60;
+
+    static QString chainKey(const QUrl &url);
+    static QString lookup(const QString &chain, int startIndex);
+    static void store(const QString &chain, int startIndex, const QString &token);
+    // the API rejected it
+    static void remove(const QString &chain, int startIndex);
+    static void prune();
+
+private:
+    PageTokenCache() { }
+
+};
+
+#endif // PAGETOKENCACHE_H
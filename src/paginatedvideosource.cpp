@@ -24,45 +24,29 @@ $END_LICENSE */
 #include "yt3listparser.h"
 #include "datautils.h"
 
-#include "video.h"
+#include "videodetailscache.h"
+#include "pagetokencache.h"
 #include "http.h"
 #include "httputils.h"
 
 PaginatedVideoSource::PaginatedVideoSource(QObject *parent) : VideoSource(parent)
-  , tokenTimestamp(0)
-  , reloadingToken(false)
+  , aborted(false)
   , currentMax(0)
   , currentStartIndex(0)
-  , asyncDetails(false) { }
+  , reloadingToken(false)
+  , asyncDetails(true)
+  , pendingDetails(0)
+  , pageMax(0)
+  , pageStartIndex(0)
+  , firstPageIndex(1)
+  , retriedToken(false) { }
 
 bool PaginatedVideoSource::hasMoreVideos() {
     qDebug() << __PRETTY_FUNCTION__ << nextPageToken;
     return !nextPageToken.isEmpty();
 }
 
-bool PaginatedVideoSource::maybeReloadToken(int max, int startIndex) {
-    // kind of hackish. Thank the genius who came up with this stateful stuff
-    // in a supposedly RESTful (aka stateless) API.
-
-    if (nextPageToken.isEmpty()) {
-        // previous request did not return a page token. Game over.
-        // emit gotVideos(QList<Video*>());
-        emit finished(0);
-        return true;
-    }
-
-    if (isPageTokenExpired()) {
-        reloadingToken = true;
-        currentMax = max;
-        currentStartIndex = startIndex;
-        reloadToken();
-        return true;
-    }
-    return false;
-}
-
 bool PaginatedVideoSource::setPageToken(const QString &value) {
-    tokenTimestamp = QDateTime::currentDateTime().toTime_t();
     nextPageToken = value;
 
     if (reloadingToken) {
@@ -75,79 +59,232 @@ bool PaginatedVideoSource::setPageToken(const QString &value) {
     return false;
 }
 
-bool PaginatedVideoSource::isPageTokenExpired() {
-    uint now = QDateTime::currentDateTime().toTime_t();
-    return now - tokenTimestamp > 1800;
+void PaginatedVideoSource::requestPage(const QUrl &url, int max, int startIndex,
+                                       HttpRequest::Priority priority) {
+    // kind of hackish. Thank the genius who came up with this stateful stuff
+    // in a supposedly RESTful (aka stateless) API.
+    const QString chain = PageTokenCache::chainKey(url);
+    QUrl tokenUrl = url;
+    if (startIndex > firstPageIndex) {
+        // a new source picks up the chain of an earlier one
+        if (nextPageToken.isEmpty() && lastUrl.isEmpty())
+            nextPageToken = PageTokenCache::lookup(chain, startIndex);
+        if (nextPageToken.isEmpty()) {
+            // previous request did not return a page token. Game over.
+            emit finished(0);
+            return;
+        }
+        // Tokens are used regardless of their age, see pageFinished().
+        // Only tokens actually used are stored, most listings stop at page one.
+        PageTokenCache::store(chain, startIndex, nextPageToken);
+        QUrlQuery q(tokenUrl);
+        q.addQueryItem("pageToken", nextPageToken);
+        tokenUrl.setQuery(q);
+    }
+
+    pageUrl = tokenUrl;
+    pageChain = chain;
+    pageMax = max;
+    pageStartIndex = startIndex;
+    pageErrorMessage.clear();
+    QObject *reply = HttpUtils::yt().get(pageUrl, priority);
+    connect(reply, SIGNAL(data(QByteArray)), SLOT(pageData(QByteArray)));
+    connect(reply, SIGNAL(error(QString)), SLOT(pageError(QString)));
+    connect(reply, SIGNAL(finished(HttpReply)), SLOT(pageFinished(HttpReply)));
+}
+
+void PaginatedVideoSource::pageData(const QByteArray &bytes) {
+    YT3ListParseTask *task = new YT3ListParseTask(bytes);
+    connect(task, SIGNAL(finished()), SLOT(pageParsed()));
+    task->start();
+}
+
+void PaginatedVideoSource::pageParsed() {
+    YT3ListParseTask *task = static_cast<YT3ListParseTask*>(sender());
+    parseResults(task->getParser());
+}
+
+void PaginatedVideoSource::pageError(const QString &message) {
+    // finished() follows and decides what to do with it
+    pageErrorMessage = message;
+}
+
+void PaginatedVideoSource::pageFinished(const HttpReply &reply) {
+    if (reply.isSuccessful()) {
+        lastUrl = pageUrl;
+        retriedToken = false;
+        return;
+    }
+
+    // The API answers 400 to a page token it no longer accepts.
+    // Get a fresh one from the previous page and retry once.
+    const bool usedToken = QUrlQuery(pageUrl).hasQueryItem("pageToken");
+    if (reply.statusCode() == 400 && usedToken)
+        PageTokenCache::remove(pageChain, pageStartIndex);
+    if (reply.statusCode() == 400 && usedToken && !retriedToken && !lastUrl.isEmpty()) {
+        retriedToken = true;
+        reloadingToken = true;
+        currentMax = pageMax;
+        currentStartIndex = pageStartIndex;
+        reloadToken();
+        return;
+    }
+
+    retriedToken = false;
+    // each source reports errors its own way
+    QMetaObject::invokeMethod(this, "requestError", Qt::DirectConnection,
+                              Q_ARG(QString, pageErrorMessage));
 }
 
 void PaginatedVideoSource::reloadToken() {
     qDebug() << "Reloading pageToken";
-    QObject *reply = HttpUtils::yt().get(lastUrl);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResults(QByteArray)));
+    // a cached copy would carry the same rejected token
+    HttpRequest req;
+    req.url = lastUrl;
+    req.headers.insert("Cache-Control", "no-cache");
+    QObject *reply = HttpUtils::yt().request(req);
+    connect(reply, SIGNAL(data(QByteArray)), SLOT(pageData(QByteArray)));
     connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
 }
 
-void PaginatedVideoSource::loadVideoDetails(const QList<Video*> &videos) {
-    QString videoIds;
-    foreach (Video *video, videos) {
-        // TODO get video details from cache
-        if (!videoIds.isEmpty()) videoIds += ",";
-        videoIds += video->id();
-        this->videos = videos;
-        videoMap.insert(video->id(), video);
+void PaginatedVideoSource::loadVideoDetails(QVector<VideoRecord> &videos) {
+    QStringList videoIds;
+    QHash<QString, int> rows;
+    for (int i = 0; i < videos.size(); ++i) {
+        videoIds << videos.at(i).id();
+        rows.insert(videos.at(i).id(), i);
     }
 
-    if (videoIds.isEmpty()) {
-        if (!asyncDetails) {
-            emit gotVideos(videos);
-            emit finished(videos.size());
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    const QHash<QString, VideoDetailsCache::Entry> known = VideoDetailsCache::lookup(videoIds);
+    QStringList missing;
+    // stale ids by the ETag of the response they came from
+    QMap<QByteArray, QStringList> stale;
+    foreach (const QString &videoId, videoIds) {
+        QHash<QString, VideoDetailsCache::Entry>::const_iterator i = known.constFind(videoId);
+        if (i == known.constEnd()) {
+            missing << videoId;
+            continue;
         }
-        return;
+        VideoRecord &record = videos[rows.value(videoId)];
+        record.setDuration(i->duration);
+        record.setViewCount(i->viewCount);
+        if (now - i->fetched > VideoDetailsCache::maxAge) stale[i->etag] << videoId;
+    }
+
+    if (!asyncDetails) {
+        records = videos;
+        recordRows = rows;
     }
 
+    // Smaller concurrent requests, so the first rows get their details sooner
+    static const int chunkSize = 10;
+    for (int i = 0; i < missing.size(); i += chunkSize)
+        requestVideoDetails(missing.mid(i, chunkSize));
+    QMap<QByteArray, QStringList>::const_iterator i;
+    for (i = stale.constBegin(); i != stale.constEnd(); ++i) {
+        const QStringList &ids = i.value();
+        // the ETag only holds for the exact set of ids it was sent with
+        if (!i.key().isEmpty() && ids.size() <= chunkSize) {
+            requestVideoDetails(ids, i.key());
+            continue;
+        }
+        for (int j = 0; j < ids.size(); j += chunkSize)
+            requestVideoDetails(ids.mid(j, chunkSize));
+    }
+
+    if (pendingDetails == 0) videoDetailsLoaded();
+}
+
+void PaginatedVideoSource::requestVideoDetails(const QStringList &videoIds, const QByteArray &etag) {
     QUrl url = YT3::instance().method("videos");
     QUrlQuery q(url);
     q.addQueryItem("part", "contentDetails,statistics");
-    q.addQueryItem("id", videoIds);
+    q.addQueryItem("id", videoIds.join(","));
     url.setQuery(q);
 
-    QObject *reply = HttpUtils::yt().get(url);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseVideoDetails(QByteArray)));
-    connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
-}
-
-void PaginatedVideoSource::parseVideoDetails(const QByteArray &bytes) {
-    QJsonDocument doc = QJsonDocument::fromJson(bytes);
-    QJsonObject obj = doc.object();
+    HttpRequest req;
+    req.url = url;
+    if (!etag.isEmpty()) req.headers.insert("If-None-Match", etag);
 
-    QJsonValue items = obj["items"];
-    if (items.isArray()) {
-        foreach (const QJsonValue &v, items.toArray()) {
-            if (!v.isObject()) continue;
+    DetailsChunk chunk;
+    chunk.videoIds = videoIds;
 
-            QJsonObject item = v.toObject();
+    pendingDetails++;
+    QObject *reply = HttpUtils::yt().request(req);
+    detailsChunks.insert(reply, chunk);
+    connect(reply, SIGNAL(finished(HttpReply)), SLOT(parseVideoDetails(HttpReply)));
+    connect(reply, SIGNAL(error(QString)), SLOT(videoDetailsError(QString)));
+}
 
-            QString id = item["id"].toString();
-            Video *video = videoMap.value(id);
-            if (!video) {
-                qWarning() << "No video for id" << id;
-                continue;
-            }
+void PaginatedVideoSource::parseVideoDetails(const HttpReply &reply) {
+    // replies of an earlier load have no chunk and must not be counted
+    if (aborted || !detailsChunks.contains(sender())) return;
+    DetailsChunk chunk = detailsChunks.take(sender());
 
-            QString isoPeriod = item["contentDetails"].toObject()["duration"].toString();
-            int duration = DataUtils::parseIsoPeriod(isoPeriod);
-            video->setDuration(duration);
+    if (reply.statusCode() == 304) {
+        // what we have is still current
+        VideoDetailsCache::touch(chunk.videoIds);
+    } else if (reply.isSuccessful()) {
+        YT3ListParseTask *task = new YT3ListParseTask(reply.body());
+        chunk.etag = reply.header("ETag");
+        detailsChunks.insert(task, chunk);
+        connect(task, SIGNAL(finished()), SLOT(videoDetailsParsed()));
+        task->start();
+        // counted when parsed
+        return;
+    }
 
-            int viewCount = item["statistics"].toObject()["viewCount"].toString().toInt();
-            video->setViewCount(viewCount);
+    if (--pendingDetails > 0) return;
+    pendingDetails = 0;
+    videoDetailsLoaded();
+}
 
-            // TODO cache by etag?
-        }
-    }
-    if (!asyncDetails) {
-        emit gotVideos(videos);
-        emit finished(videos.size());
+void PaginatedVideoSource::videoDetailsParsed() {
+    if (aborted || !detailsChunks.contains(sender())) return;
+    YT3ListParseTask *task = static_cast<YT3ListParseTask*>(sender());
+    const DetailsChunk chunk = detailsChunks.take(task);
+    const YT3ListParser &parser = task->getParser();
+    if (asyncDetails) {
+        // receivers match them by id, rows that are gone meanwhile are skipped
+        emit gotDetails(parser.getRecords());
     } else {
-        emit gotDetails();
+        foreach (const VideoRecord &record, parser.getRecords()) {
+            QHash<QString, int>::const_iterator i = recordRows.constFind(record.id());
+            if (i == recordRows.constEnd()) continue;
+            records[i.value()].setDuration(record.duration());
+            records[i.value()].setViewCount(record.viewCount());
+        }
     }
+    QByteArray etag = chunk.etag;
+    if (etag.isEmpty()) etag = parser.getEtag().toUtf8();
+    VideoDetailsCache::store(parser.getRecords(), etag);
+
+    if (--pendingDetails > 0) return;
+    pendingDetails = 0;
+    videoDetailsLoaded();
+}
+
+void PaginatedVideoSource::abort() {
+    aborted = true;
+    // late details responses find nothing to update
+    detailsChunks.clear();
+    pendingDetails = 0;
+    records.clear();
+    recordRows.clear();
+}
+
+void PaginatedVideoSource::videoDetailsError(const QString &message) {
+    // videos are usable without details, finished() follows and completes the page
+    qWarning() << "Cannot load video details" << message;
+}
+
+void PaginatedVideoSource::videoDetailsLoaded() {
+    // with async details each chunk was emitted as it arrived
+    if (asyncDetails) return;
+    const QVector<VideoRecord> loaded = records;
+    records.clear();
+    recordRows.clear();
+    emit gotVideos(loaded);
+    emit finished(loaded.size());
 }
@@ -22,6 +22,9 @@ $END_LICENSE */
 #define PAGINATEDVIDEOSOURCE_H
 
 #include "videosource.h"
+#include "http.h"
+
+class YT3ListParser;
 
 class PaginatedVideoSource : public VideoSource {
 
@@ -31,29 +34,70 @@ public:
     PaginatedVideoSource(QObject *parent = 0);
     virtual bool hasMoreVideos();
 
-    bool maybeReloadToken(int max, int startIndex);
     bool setPageToken(const QString &value);
-    bool isPageTokenExpired();
     void reloadToken();
+    /**
+      * When true (the default) sources emit videos as soon as the listing is
+      * parsed, and gotDetails() follows once durations and view counts
+      * arrive. Otherwise gotVideos() waits for all the details.
+      */
     void setAsyncDetails(bool value) { asyncDetails = value; }
-    void loadVideoDetails(const QList<Video*> &videos);
-
-signals:
-    void gotDetails();
+    // fills in the details known to VideoDetailsCache and requests the others
+    void loadVideoDetails(QVector<VideoRecord> &videos);
+    void abort();
 
 protected slots:
-    void parseVideoDetails(const QByteArray &bytes);
+    void pageData(const QByteArray &bytes);
+    void pageParsed();
+    void pageError(const QString &message);
+    void pageFinished(const HttpReply &reply);
+    void parseVideoDetails(const HttpReply &reply);
+    void videoDetailsParsed();
+    void videoDetailsError(const QString &message);
 
 protected:
+    struct DetailsChunk {
+        QStringList videoIds;
+        // ETag header of the response, once it's being parsed
+        QByteArray etag;
+    };
+
+    // Sends a page request, the response is parsed off the GUI thread
+    // and handed to parseResults(). Pages after firstPageIndex get the
+    // next page token, emits finished(0) when the listing has no more pages.
+    void requestPage(const QUrl &url, int max, int startIndex,
+                     HttpRequest::Priority priority = HttpRequest::NormalPriority);
+    void requestVideoDetails(const QStringList &videoIds, const QByteArray &etag = QByteArray());
+    void videoDetailsLoaded();
+    // called in the GUI thread with a parsed page
+    virtual void parseResults(const YT3ListParser &parser) = 0;
+
+    // set by abort(), subclasses clear it when loading again
+    bool aborted;
     QString nextPageToken;
-    uint tokenTimestamp;
+    // last page that loaded, reloading it yields a fresh token for the next one
     QUrl lastUrl;
     int currentMax;
     int currentStartIndex;
     bool reloadingToken;
-    QList<Video*> videos;
-    QHash<QString, Video*> videoMap;
     bool asyncDetails;
+    // without async details, the page waiting for them and its rows by id
+    QVector<VideoRecord> records;
+    QHash<QString, int> recordRows;
+
+    // details requests still in flight, and their chunks by reply or parse task
+    int pendingDetails;
+    QHash<QObject*, DetailsChunk> detailsChunks;
+
+    // the page request in flight, its chain in PageTokenCache
+    QUrl pageUrl;
+    QString pageChain;
+    int pageMax;
+    int pageStartIndex;
+    // earlier pages are requested without a token
+    int firstPageIndex;
+    QString pageErrorMessage;
+    bool retriedToken;
 
 };
 
@@ -0,0 +1,57 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "playerdecipher.h"
+
+PlayerDecipher &PlayerDecipher::instance() {
+    static PlayerDecipher i;
+    return i;
+}
+
+void PlayerDecipher::compile(const QString &playerUrl, const QString &functionName,
+                             const QList<QString> &sources) {
+    delete engine;
+    engine = new QJSEngine();
+    results.clear();
+    this->playerUrl = playerUrl;
+    foreach (const QString &source, sources) {
+        QJSValue value = engine->evaluate(source);
+        if (value.isError())
+            qWarning() << "Error in" << source << value.toString();
+    }
+    function = engine->globalObject().property(functionName);
+    if (!function.isCallable())
+        qWarning() << "Cannot compile signature function" << functionName;
+}
+
+QString PlayerDecipher::decipher(const QString &s) {
+    QHash<QString, QString>::const_iterator i = results.constFind(s);
+    if (i != results.constEnd()) return i.value();
+
+    QJSValue value = function.call(QJSValueList() << s);
+    if (value.isUndefined() || value.isError()) {
+        qWarning() << "Cannot decipher" << s << value.toString();
+        return QString();
+    }
+    if (results.size() > 1000) results.clear();
+    const QString result = value.toString();
+    results.insert(s, result);
+    return result;
+}
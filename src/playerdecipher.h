@@ -0,0 +1,57 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef PLAYERDECIPHER_H
+#define PLAYERDECIPHER_H
+
+#include <QtCore>
+#include <QJSEngine>
+#include <QJSValue>
+
+/**
+  * Signature functions of the js player seen last, compiled once and
+  * shared by all videos. Deciphered signatures are memoized too.
+  */
+class PlayerDecipher {
+
+public:
+    static PlayerDecipher &instance();
+
+    bool isReady(const QString &playerUrl) const {
+        return !playerUrl.isEmpty() && playerUrl == this->playerUrl && function.isCallable();
+    }
+
+    // sources are evaluated in order, objects before the functions using them
+    void compile(const QString &playerUrl, const QString &functionName,
+                 const QList<QString> &sources);
+    // empty if the function failed
+    QString decipher(const QString &s);
+
+private:
+    PlayerDecipher() : engine(0) { }
+
+    QString playerUrl;
+    QJSEngine *engine;
+    QJSValue function;
+    QHash<QString, QString> results;
+
+};
+
+#endif // PLAYERDECIPHER_H
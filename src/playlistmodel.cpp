@@ -26,6 +26,8 @@ $END_LICENSE */
 #include "searchparams.h"
 #include "mediaview.h"
 
+#include <algorithm>
+
 static const int maxItems = 50;
 static const QString recentKeywordsKey = "recentKeywords";
 static const QString recentChannelsKey = "recentChannels";
@@ -39,16 +41,23 @@ PlaylistModel::PlaylistModel(QWidget *parent) : QAbstractListModel(parent) {
     m_activeRow = -1;
     startIndex = 1;
     max = 0;
+    prefetching = false;
+    prefetchWanted = false;
+    prefetchFinished = false;
+    prefetchTotal = 0;
+    prefetchTimer = new QTimer(this);
+    prefetchTimer->setSingleShot(true);
+    connect(prefetchTimer, SIGNAL(timeout()), SLOT(prefetch()));
     hoveredRow = -1;
     authorHovered = false;
     authorPressed = false;
 }
 
 int PlaylistModel::rowCount(const QModelIndex &/*parent*/) const {
-    int count = videos.size();
+    int count = rows.size();
     
     // add the message item
-    if (videos.isEmpty() || !searching)
+    if (rows.isEmpty() || !searching)
         count++;
     
     return count;
@@ -58,7 +67,7 @@ QVariant PlaylistModel::data(const QModelIndex &index, int role) const {
     
     int row = index.row();
     
-    if (row == videos.size()) {
+    if (row == rows.size()) {
         
         QPalette palette;
         
@@ -69,7 +78,7 @@ QVariant PlaylistModel::data(const QModelIndex &index, int role) const {
             if (!errorMessage.isEmpty()) return errorMessage;
             if (searching) return tr("Searching...");
             if (canSearchMore) return tr("Show %1 More").arg("").simplified();
-            if (videos.isEmpty()) return tr("No videos");
+            if (rows.isEmpty()) return tr("No videos");
             else return tr("No more videos");
         case Qt::TextAlignmentRole:
             return QVariant(int(Qt::AlignHCenter | Qt::AlignVCenter));
@@ -87,20 +96,21 @@ QVariant PlaylistModel::data(const QModelIndex &index, int role) const {
             return QVariant();
         }
         
-    } else if (row < 0 || row >= videos.size())
+    } else if (row < 0 || row >= rows.size())
         return QVariant();
     
-    Video *video = videos.at(row);
+    const Row &item = rows.at(row);
     
     switch (role) {
     case ItemTypeRole:
         return ItemTypeVideo;
     case VideoRole:
-        return QVariant::fromValue(QPointer<Video>(video));
+        // the delegate asks for rows it paints, so only those get a Video
+        return QVariant::fromValue(QPointer<Video>(videoAt(row)));
     case ActiveTrackRole:
-        return video == m_activeVideo;
+        return m_activeVideo && item.video == m_activeVideo;
     case Qt::DisplayRole:
-        return video->title();
+        return item.record.title();
     case HoveredItemRole:
         return hoveredRow == index.row();
     case AuthorHoveredRole:
@@ -152,27 +162,40 @@ int PlaylistModel::previousRow() const {
 }
 
 Video* PlaylistModel::videoAt( int row ) const {
-    if ( rowExists( row ) )
-        return videos.at( row );
-    return 0;
+    if ( !rowExists( row ) ) return 0;
+    const Row &item = rows.at(row);
+    if (!item.video) {
+        item.video = new Video(item.record);
+        connect(item.video, SIGNAL(gotThumbnail()), SLOT(updateVideoSender()));
+        connect(item.video, SIGNAL(detailsChanged()), SLOT(updateVideoSender()));
+        item.video->loadThumbnail();
+    }
+    return item.video;
 }
 
 Video* PlaylistModel::activeVideo() const {
     return m_activeVideo;
 }
 
+VideoSource* PlaylistModel::getVideoSource() {
+    return videoSource;
+}
+
 void PlaylistModel::setVideoSource(VideoSource *videoSource) {
+    cancelPrefetch();
     beginResetModel();
-    while (!videos.isEmpty()) delete videos.takeFirst();
-    videos.clear();
+    foreach (const Row &item, rows) delete item.video;
+    rows.clear();
     m_activeVideo = 0;
     m_activeRow = -1;
     startIndex = 1;
     endResetModel();
 
     this->videoSource = videoSource;
-    connect(videoSource, SIGNAL(gotVideos(QList<Video*>)),
-            SLOT(addVideos(QList<Video*>)), Qt::UniqueConnection);
+    connect(videoSource, SIGNAL(gotVideos(QVector<VideoRecord>)),
+            SLOT(addVideos(QVector<VideoRecord>)), Qt::UniqueConnection);
+    connect(videoSource, SIGNAL(gotDetails(QVector<VideoRecord>)),
+            SLOT(updateDetails(QVector<VideoRecord>)), Qt::UniqueConnection);
     connect(videoSource, SIGNAL(finished(int)),
             SLOT(searchFinished(int)), Qt::UniqueConnection);
     connect(videoSource, SIGNAL(error(QString)),
@@ -183,6 +206,15 @@ void PlaylistModel::setVideoSource(VideoSource *videoSource) {
 
 void PlaylistModel::searchMore(int max) {
     if (searching) return;
+    if (prefetching) {
+        // the next page is already here or on its way
+        searching = true;
+        firstSearch = false;
+        errorMessage.clear();
+        if (prefetchFinished) takePrefetched();
+        else prefetchWanted = true;
+        return;
+    }
     searching = true;
     firstSearch = startIndex == 1;
     this->max = max;
@@ -195,19 +227,50 @@ void PlaylistModel::searchMore() {
     searchMore(maxItems);
 }
 
+void PlaylistModel::prefetch() {
+    if (searching || prefetching || !canSearchMore || !videoSource) return;
+    prefetching = true;
+    prefetchWanted = false;
+    prefetchFinished = false;
+    videoSource->loadVideos(maxItems, startIndex);
+    startIndex += maxItems;
+}
+
+void PlaylistModel::takePrefetched() {
+    const QVector<VideoRecord> prefetched = prefetchedVideos;
+    prefetchedVideos.clear();
+    prefetching = false;
+    addVideos(prefetched);
+    searchFinished(prefetchTotal);
+}
+
+void PlaylistModel::cancelPrefetch() {
+    prefetchTimer->stop();
+    if (prefetching && !prefetchFinished && videoSource) {
+        // a late page must not land in whatever the model shows next
+        disconnect(videoSource.data(), 0, this, 0);
+        videoSource->abort();
+    }
+    prefetchedVideos.clear();
+    prefetching = false;
+    prefetchWanted = false;
+    prefetchFinished = false;
+}
+
 void PlaylistModel::searchNeeded() {
     const int desiredRowsAhead = 10;
-    int remainingRows = videos.size() - m_activeRow;
+    int remainingRows = rows.size() - m_activeRow;
     if (remainingRows < desiredRowsAhead)
         searchMore(maxItems);
 }
 
 void PlaylistModel::abortSearch() {
     QMutexLocker locker(&mutex);
+    cancelPrefetch();
     beginResetModel();
     // while (!videos.isEmpty()) delete videos.takeFirst();
     // if (videoSource) videoSource->abort();
-    videos.clear();
+    rows.clear();
     searching = false;
     m_activeRow = -1;
     m_activeVideo = 0;
@@ -216,6 +279,15 @@ void PlaylistModel::abortSearch() {
 }
 
 void PlaylistModel::searchFinished(int total) {
+    if (prefetching) {
+        if (!prefetchWanted) {
+            prefetchFinished = true;
+            prefetchTotal = total;
+            return;
+        }
+        prefetching = false;
+    }
+
     searching = false;
     canSearchMore = videoSource->hasMoreVideos();
 
@@ -225,30 +297,63 @@ void PlaylistModel::searchFinished(int total) {
     if (!videoSource->getSuggestions().isEmpty())
         emit haveSuggestions(videoSource->getSuggestions());
 
-    if (firstSearch && !videos.isEmpty())
-        handleFirstVideo(videos.first());
+    if (firstSearch && !rows.isEmpty())
+        handleFirstVideo(rows.first().record);
+
+    // after the current call chain, sources may still be busy with this page
+    if (canSearchMore && errorMessage.isEmpty()) prefetchTimer->start(0);
 }
 
 void PlaylistModel::searchError(const QString &message) {
+    if (prefetching && !prefetchWanted) {
+        // stay quiet, searchMore() will request this page again
+        prefetchedVideos.clear();
+        prefetching = false;
+        startIndex -= maxItems;
+        return;
+    }
+    prefetching = false;
     errorMessage = message;
     // update the message item
     emit dataChanged( createIndex( maxItems, 0 ), createIndex( maxItems, columnCount() - 1 ) );
 }
 
-void PlaylistModel::addVideos(QList<Video*> newVideos) {
+void PlaylistModel::addVideos(const QVector<VideoRecord> &newVideos) {
+    if (prefetching && !prefetchWanted) {
+        prefetchedVideos += newVideos;
+        return;
+    }
     if (newVideos.isEmpty()) return;
-    beginInsertRows(QModelIndex(), videos.size(), videos.size() + newVideos.size() - 2);
-    videos.append(newVideos);
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + newVideos.size() - 2);
+    rows.reserve(rows.size() + newVideos.size());
+    foreach (const VideoRecord &record, newVideos) rows << Row(record);
     endInsertRows();
-    foreach (Video* video, newVideos) {
-        connect(video, SIGNAL(gotThumbnail()),
-                SLOT(updateVideoSender()), Qt::UniqueConnection);
-        video->loadThumbnail();
-        qApp->processEvents();
+}
+
+void PlaylistModel::updateDetails(const QVector<VideoRecord> &videos) {
+    QHash<QString, VideoRecord> details;
+    foreach (const VideoRecord &video, videos) details.insert(video.id(), video);
+
+    for (int i = 0; i < rows.size(); ++i) {
+        QHash<QString, VideoRecord>::const_iterator d = details.constFind(rows.at(i).record.id());
+        if (d == details.constEnd()) continue;
+        Row &item = rows[i];
+        item.record.setDuration(d->duration());
+        item.record.setViewCount(d->viewCount());
+        // the Video repaints its row through updateVideoSender()
+        if (item.video) item.video->setDetails(d->duration(), d->viewCount());
+        else emit dataChanged(createIndex(i, 0), createIndex(i, columnCount() - 1));
+    }
+
+    for (int i = 0; i < prefetchedVideos.size(); ++i) {
+        QHash<QString, VideoRecord>::const_iterator d = details.constFind(prefetchedVideos.at(i).id());
+        if (d == details.constEnd()) continue;
+        prefetchedVideos[i].setDuration(d->duration());
+        prefetchedVideos[i].setViewCount(d->viewCount());
     }
 }
 
-void PlaylistModel::handleFirstVideo(Video *video) {
+void PlaylistModel::handleFirstVideo(const VideoRecord &video) {
 
     int currentVideoRow = rowForCloneVideo(MediaView::instance()->getCurrentVideoId());
     if (currentVideoRow != -1) setActiveRow(currentVideoRow, false);
@@ -277,7 +382,7 @@ void PlaylistModel::handleFirstVideo(Video *video) {
         if (!query.isEmpty() && !searchParams->isTransient()) {
             if (query.startsWith("http://")) {
                 // Save the video title
-                query += "|" + videos.first()->title();
+                query += "|" + video.title();
             }
             QStringList keywords = settings.value(recentKeywordsKey).toStringList();
             keywords.removeAll(query);
@@ -291,9 +396,9 @@ void PlaylistModel::handleFirstVideo(Video *video) {
         QString channelId = searchParams->channelId();
         if (!channelId.isEmpty() && !searchParams->isTransient()) {
             QString value;
-            if (!video->channelId().isEmpty() && video->channelId() != video->channelTitle())
-                value = video->channelId() + "|" + video->channelTitle();
-            else value = video->channelTitle();
+            if (!video.channelId().isEmpty() && video.channelId() != video.channelTitle())
+                value = video.channelId() + "|" + video.channelTitle();
+            else value = video.channelTitle();
             QStringList channels = settings.value(recentChannelsKey).toStringList();
             channels.removeAll(value);
             channels.removeAll(channelId);
@@ -325,28 +430,29 @@ void PlaylistModel::emitDataChanged() {
 /**
   * This function does not free memory
   */
-bool PlaylistModel::removeRows(int position, int rows, const QModelIndex & /*parent*/) {
-    beginRemoveRows(QModelIndex(), position, position+rows-1);
-    for (int row = 0; row < rows; ++row) {
-        videos.removeAt(position);
-    }
+bool PlaylistModel::removeRows(int position, int count, const QModelIndex & /*parent*/) {
+    beginRemoveRows(QModelIndex(), position, position+count-1);
+    rows.remove(position, count);
     endRemoveRows();
     return true;
 }
 
 void PlaylistModel::removeIndexes(QModelIndexList &indexes) {
-    QList<Video*> originalList(videos);
-    QList<Video*> delitems;
+    QList<int> removedRows;
     foreach (const QModelIndex &index, indexes) {
-        if (index.row() >= originalList.size()) continue;
-        Video* video = originalList.at(index.row());
-        int idx = videos.indexOf(video);
-        if (idx != -1) {
-            beginRemoveRows(QModelIndex(), idx, idx);
-            delitems.append(video);
-            videos.removeAll(video);
-            endRemoveRows();
-        }
+        if (!rowExists(index.row()) || removedRows.contains(index.row())) continue;
+        removedRows << index.row();
+    }
+    std::sort(removedRows.begin(), removedRows.end());
+
+    // from the bottom up, so the remaining row numbers stay valid
+    QList<Video*> delitems;
+    for (int i = removedRows.size() - 1; i >= 0; --i) {
+        const int row = removedRows.at(i);
+        if (rows.at(row).video) delitems.append(rows.at(row).video);
+        beginRemoveRows(QModelIndex(), row, row);
+        rows.remove(row);
+        endRemoveRows();
     }
 
     qDeleteAll(delitems);
@@ -367,7 +473,7 @@ Qt::DropActions PlaylistModel::supportedDragActions() const {
 
 Qt::ItemFlags PlaylistModel::flags(const QModelIndex &index) const {
     if (index.isValid()) {
-        if (index.row() == videos.size()) {
+        if (index.row() == rows.size()) {
             // don't drag the "show more" item
             return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
         } else return (Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled);
@@ -386,8 +492,8 @@ QMimeData* PlaylistModel::mimeData( const QModelIndexList &indexes ) const {
 
     foreach( const QModelIndex &it, indexes ) {
         int row = it.row();
-        if (row >= 0 && row < videos.size())
-            mime->addVideo( videos.at( it.row() ) );
+        if (row >= 0 && row < rows.size())
+            mime->addVideo( videoAt( it.row() ) );
     }
 
     return mime;
@@ -420,18 +526,20 @@ bool PlaylistModel::dropMimeData(const QMimeData *data,
     foreach( Video *video, droppedVideos) {
         
         // remove videos
-        int videoRow = videos.indexOf(video);
+        int videoRow = rowForVideo(video);
+        if (videoRow == -1) continue;
+        const Row item = rows.at(videoRow);
         removeRows(videoRow, 1, QModelIndex());
         
         // and then add them again at the new position
         beginInsertRows(QModelIndex(), beginRow, beginRow);
-        videos.insert(beginRow, video);
+        rows.insert(beginRow, item);
         endInsertRows();
 
     }
 
     // fix m_activeRow after all this
-    m_activeRow = videos.indexOf(m_activeVideo);
+    m_activeRow = rowForVideo(m_activeVideo);
 
     // let the MediaView restore the selection
     emit needSelectionFor(droppedVideos);
@@ -442,20 +550,23 @@ bool PlaylistModel::dropMimeData(const QMimeData *data,
 
 int PlaylistModel::rowForCloneVideo(const QString &videoId) const {
     if (videoId.isEmpty()) return -1;
-    for (int i = 0; i < videos.size(); ++i) {
-        Video *v = videos.at(i);
-        // qDebug() << "Comparing" << v->id() << videoId;
-        if (v->id() == videoId) return i;
+    for (int i = 0; i < rows.size(); ++i) {
+        // qDebug() << "Comparing" << rows.at(i).record.id() << videoId;
+        if (rows.at(i).record.id() == videoId) return i;
     }
     return -1;
 }
 
 int PlaylistModel::rowForVideo(Video* video) {
-    return videos.indexOf(video);
+    // rows without a Video must not match a null one
+    if (!video) return -1;
+    for (int i = 0; i < rows.size(); ++i)
+        if (rows.at(i).video == video) return i;
+    return -1;
 }
 
 QModelIndex PlaylistModel::indexForVideo(Video* video) {
-    return createIndex(videos.indexOf(video), 0);
+    return createIndex(rowForVideo(video), 0);
 }
 
 void PlaylistModel::move(QModelIndexList &indexes, bool up) {
@@ -463,7 +574,7 @@ void PlaylistModel::move(QModelIndexList &indexes, bool up) {
 
     foreach (const QModelIndex &index, indexes) {
         int row = index.row();
-        if (row >= videos.size()) continue;
+        if (row >= rows.size()) continue;
         // qDebug() << "index row" << row;
         Video *video = videoAt(row);
         movedVideos << video;
@@ -475,13 +586,14 @@ void PlaylistModel::move(QModelIndexList &indexes, bool up) {
         int row = rowForVideo(video);
         if (row+mod==end) { end=row; continue; }
         // qDebug() << "video row" << row;
+        const Row item = rows.at(row);
         removeRows(row, 1, QModelIndex());
 
         if (up) row--;
         else row++;
 
         beginInsertRows(QModelIndex(), row, row);
-        videos.insert(row, video);
+        rows.insert(row, item);
         endInsertRows();
 
     }
@@ -22,6 +22,7 @@ $END_LICENSE */
 #define PLAYLISTMODEL_H
 
 #include <QtWidgets>
+#include "videorecord.h"
 
 class Video;
 class VideoSource;
@@ -65,7 +66,7 @@ public:
                       const QModelIndex &parent);
 
     void setActiveRow(int row , bool notify = true);
-    bool rowExists( int row ) const { return (( row >= 0 ) && ( row < videos.size() ) ); }
+    bool rowExists( int row ) const { return (( row >= 0 ) && ( row < rows.size() ) ); }
     int activeRow() const { return m_activeRow; } // returns -1 if there is no active row
     int nextRow() const;
     int previousRow() const;
@@ -74,18 +75,20 @@ public:
     QModelIndex indexForVideo(Video* video);
     void move(QModelIndexList &indexes, bool up);
 
+    // creates the Video for this row if it has none yet
     Video* videoAt( int row ) const;
     Video* activeVideo() const;
     int rowForCloneVideo(const QString &videoId) const;
 
-    VideoSource* getVideoSource() { return videoSource; }
+    VideoSource* getVideoSource();
     void setVideoSource(VideoSource *videoSource);
     void abortSearch();
 
 public slots:
     void searchMore();
     void searchNeeded();
-    void addVideos(QList<Video*> newVideos);
+    void addVideos(const QVector<VideoRecord> &newVideos);
+    void updateDetails(const QVector<VideoRecord> &videos);
     void searchFinished(int total);
     void searchError(const QString &message);
     void updateVideoSender();
@@ -100,24 +103,45 @@ public slots:
     void enterAuthorPressed();
     void exitAuthorPressed();
 
+private slots:
+    void prefetch();
+
 signals:
     void activeRowChanged(int);
     void needSelectionFor(QList<Video*>);
     void haveSuggestions(const QStringList &suggestions);
 
 private:
-    void handleFirstVideo(Video* video);
+    void handleFirstVideo(const VideoRecord &video);
     void searchMore(int max);
+    void takePrefetched();
+    void cancelPrefetch();
 
-    VideoSource *videoSource;
+    QPointer<VideoSource> videoSource;
     bool searching;
     bool canSearchMore;
     bool firstSearch;
 
-    QList<Video*> videos;
+    struct Row {
+        Row() : video(0) { }
+        Row(const VideoRecord &record) : record(record), video(0) { }
+        VideoRecord record;
+        // created on first use, most rows never need one
+        mutable Video *video;
+    };
+    QVector<Row> rows;
     int startIndex;
     int max;
 
+    // Next page, requested as soon as the current one is shown.
+    // Until searchMore() asks for it, its videos are kept here.
+    QTimer *prefetchTimer;
+    bool prefetching;
+    bool prefetchWanted;
+    bool prefetchFinished;
+    int prefetchTotal;
+    QVector<VideoRecord> prefetchedVideos;
+
     int m_activeRow;
     Video *m_activeVideo;
 
@@ -0,0 +1,85 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "streamurlcache.h"
+
+namespace {
+
+// for URLs without an expire= parameter
+static const uint defaultLifetime = 60 * 60;
+
+QHash<QString, StreamUrlCache::Entry> &entries() {
+    static QHash<QString, StreamUrlCache::Entry> entries;
+    return entries;
+}
+
+QString key(const QString &videoId, const QString &definitionName) {
+    return videoId + QLatin1Char('|') + definitionName;
+}
+
+uint now() {
+    return QDateTime::currentDateTimeUtc().toTime_t();
+}
+
+}
+
+bool StreamUrlCache::lookup(const QString &videoId, const QString &definitionName, Entry &entry) {
+    QHash<QString, Entry>::const_iterator i = entries().constFind(key(videoId, definitionName));
+    if (i == entries().constEnd()) return false;
+    if (i.value().expires < now() + refreshMargin) return false;
+    entry = i.value();
+    return true;
+}
+
+void StreamUrlCache::store(const QString &videoId, const QString &definitionName,
+                           const QUrl &url, int definitionCode) {
+    QHash<QString, Entry> &hash = entries();
+
+    // drop what can't be served anymore, keeps the hash small
+    const uint limit = now() + refreshMargin;
+    QHash<QString, Entry>::iterator i = hash.begin();
+    while (i != hash.end()) {
+        if (i.value().expires < limit) i = hash.erase(i);
+        else ++i;
+    }
+
+    Entry entry;
+    entry.url = url;
+    entry.definitionCode = definitionCode;
+    entry.expires = expiryOf(url);
+    hash.insert(key(videoId, definitionName), entry);
+}
+
+void StreamUrlCache::remove(const QString &videoId) {
+    const QString prefix = videoId + QLatin1Char('|');
+    QHash<QString, Entry> &hash = entries();
+    QHash<QString, Entry>::iterator i = hash.begin();
+    while (i != hash.end()) {
+        if (i.key().startsWith(prefix)) i = hash.erase(i);
+        else ++i;
+    }
+}
+
+uint StreamUrlCache::expiryOf(const QUrl &url) {
+    bool ok = false;
+    const uint expire = QUrlQuery(url).queryItemValue("expire").toUInt(&ok);
+    if (ok && expire > 0) return expire;
+    return now() + defaultLifetime;
+}
@@ -0,0 +1,58 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef STREAMURLCACHE_H
+#define STREAMURLCACHE_H
+
+#include <QtCore>
+
+/**
+  * Resolved stream URLs by video id and definition, kept in memory.
+  * Stream URLs carry their own expire= timestamp and are only handed
+  * out while they have at least refreshMargin seconds to live.
+  */
+class StreamUrlCache {
+
+public:
+    struct Entry {
+        Entry() : definitionCode(0), expires(0) { }
+        QUrl url;
+        // the definition actually found, may be lower than the requested one
+        int definitionCode;
+        uint expires;
+    };
+
+    // how long before expiry entries stop being served and get refreshed
+    static const uint refreshMargin = 5 * 60;
+
+    static bool lookup(const QString &videoId, const QString &definitionName, Entry &entry);
+    static void store(const QString &videoId, const QString &definitionName,
+                      const QUrl &url, int definitionCode);
+    // for URLs that turned out not to work
+    static void remove(const QString &videoId);
+    // the expire= timestamp of a stream URL or a guess when there's none
+    static uint expiryOf(const QUrl &url);
+
+private:
+    StreamUrlCache() { }
+
+};
+
+#endif // STREAMURLCACHE_H
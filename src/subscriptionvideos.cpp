@@ -0,0 +1,104 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "subscriptionvideos.h"
+#include "videorecord.h"
+#include "database.h"
+#include <QtSql>
+
+int SubscriptionVideos::add(int channelId, const QVector<VideoRecord> &videos) {
+    if (videos.isEmpty()) return 0;
+
+    Database &database = Database::instance();
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    const int count = videos.size();
+
+    QVariantList ids, channelIds, published, added, watched, titles, authors, userIds,
+            descriptions, urls, thumbUrls, views, durations;
+    ids.reserve(count);
+    published.reserve(count);
+    titles.reserve(count);
+    foreach (const VideoRecord &video, videos) {
+        uint publishedTime = video.published().toTime_t();
+        if (publishedTime > now) {
+            qDebug() << "fixing publish time";
+            publishedTime = now;
+        }
+        ids << video.id();
+        channelIds << channelId;
+        published << publishedTime;
+        added << now;
+        watched << 0;
+        titles << video.title();
+        authors << video.channelTitle();
+        userIds << video.channelId();
+        descriptions << video.description();
+        urls << (video.webpage().isEmpty()
+                 ? QString("https://www.youtube.com/watch?v=" + video.id()) : video.webpage());
+        thumbUrls << video.thumbnailUrl();
+        views << video.viewCount();
+        durations << video.duration();
+    }
+
+    const int changesBefore = totalChanges();
+
+    QSqlQuery insertQuery = database.cachedQuery(
+                "insert or ignore into subscriptions_videos "
+                "(video_id,channel_id,published,added,watched,"
+                "title,author,user_id,description,url,thumb_url,views,duration) "
+                "values (?,?,?,?,?,?,?,?,?,?,?,?,?)");
+    insertQuery.bindValue(0, ids);
+    insertQuery.bindValue(1, channelIds);
+    insertQuery.bindValue(2, published);
+    insertQuery.bindValue(3, added);
+    insertQuery.bindValue(4, watched);
+    insertQuery.bindValue(5, titles);
+    insertQuery.bindValue(6, authors);
+    insertQuery.bindValue(7, userIds);
+    insertQuery.bindValue(8, descriptions);
+    insertQuery.bindValue(9, urls);
+    insertQuery.bindValue(10, thumbUrls);
+    insertQuery.bindValue(11, views);
+    insertQuery.bindValue(12, durations);
+    bool success = insertQuery.execBatch();
+    if (!success) qWarning() << insertQuery.lastQuery() << insertQuery.lastError().text();
+
+    // already known videos are ignored and not counted
+    const int inserted = totalChanges() - changesBefore;
+    if (inserted <= 0) return 0;
+
+    QSqlQuery updateQuery = database.cachedQuery(Database::channelUpdatedSql);
+    updateQuery.bindValue(0, channelId);
+    updateQuery.bindValue(1, channelId);
+    success = updateQuery.exec();
+    if (!success) qWarning() << updateQuery.lastQuery() << updateQuery.lastError().text();
+
+    return inserted;
+}
+
+int SubscriptionVideos::totalChanges() {
+    QSqlQuery query = Database::instance().cachedQuery("select total_changes()");
+    bool success = query.exec();
+    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+    if (!query.next()) return 0;
+    const int changes = query.value(0).toInt();
+    query.finish();
+    return changes;
+}
@@ -0,0 +1,49 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef SUBSCRIPTIONVIDEOS_H
+#define SUBSCRIPTIONVIDEOS_H
+
+#include <QtCore>
+
+class VideoRecord;
+
+/**
+  * Videos of subscribed channels, stored in the database.
+  * Only SQL, callers map channels to their subscription row id.
+  */
+class SubscriptionVideos {
+
+public:
+    /**
+      * Stores the videos of the subscription with the given row id,
+      * videos already known are skipped. Updates the subscription's
+      * most recent video time if anything was new.
+      * Returns how many videos were new.
+      */
+    static int add(int channelId, const QVector<VideoRecord> &videos);
+
+private:
+    SubscriptionVideos() { }
+    static int totalChanges();
+
+};
+
+#endif // SUBSCRIPTIONVIDEOS_H
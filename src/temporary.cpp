@@ -22,13 +22,14 @@ $END_LICENSE */
 #include "constants.h"
 
 static QList<QString> paths;
+static QString lookAheadPath;
 #ifdef APP_LINUX
 static QString userName;
 #endif
 
 Temporary::Temporary() { }
 
-QString Temporary::filename() {
+QString Temporary::newFilename() {
     static const QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
 
     QString tempFile = tempDir + "/" + Constants::UNIX_NAME + "-" + QString::number(qrand());
@@ -45,27 +46,40 @@ QString Temporary::filename() {
 
     // tempFile += ".mp4";
 
-    if (QFile::exists(tempFile) && !QFile::remove(tempFile)) {
-        qDebug() << "Cannot remove temp file" << tempFile;
-    }
+    remove(tempFile);
+    return tempFile;
+}
 
+QString Temporary::filename() {
+    QString tempFile = newFilename();
     paths << tempFile;
 
-    if (paths.size() > 1) {
-        QString removedFile = paths.takeFirst();
-        if (QFile::exists(removedFile) && !QFile::remove(removedFile)) {
-            qDebug() << "Cannot remove temp file" << removedFile;
-        }
-    }
+    if (paths.size() > 1) remove(paths.takeFirst());
 
     return tempFile;
+}
 
+QString Temporary::lookAheadFilename() {
+    // the current file is left alone, it's most likely playing
+    if (!lookAheadPath.isEmpty()) remove(lookAheadPath);
+    lookAheadPath = newFilename();
+    return lookAheadPath;
 }
 
-void Temporary::deleteAll() {
-    foreach(const QString &path, paths) {
-        if (QFile::exists(path) && !QFile::remove(path)) {
-            qDebug() << "Cannot remove temp file" << path;
-        }
+void Temporary::promoteLookAhead() {
+    if (lookAheadPath.isEmpty()) return;
+    while (!paths.isEmpty()) remove(paths.takeFirst());
+    paths << lookAheadPath;
+    lookAheadPath.clear();
+}
+
+void Temporary::remove(const QString &path) {
+    if (QFile::exists(path) && !QFile::remove(path)) {
+        qDebug() << "Cannot remove temp file" << path;
     }
 }
+
+void Temporary::deleteAll() {
+    foreach(const QString &path, paths) remove(path);
+    if (!lookAheadPath.isEmpty()) remove(lookAheadPath);
+}
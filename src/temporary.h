@@ -28,10 +28,16 @@ class Temporary {
 
 public:
     static QString filename();
+    // a second file with its own lifetime, for the video that plays next
+    static QString lookAheadFilename();
+    // the look-ahead file becomes the current one, replacing it
+    static void promoteLookAhead();
     static void deleteAll();
 
 private:
     Temporary();
+    static QString newFilename();
+    static void remove(const QString &path);
 
 };
 
@@ -25,71 +25,135 @@ $END_LICENSE */
 #include "jsfunctions.h"
 #include "temporary.h"
 #include "datautils.h"
+#include "streamurlcache.h"
+#include "playerdecipher.h"
+#include "fmturlmap.h"
 
 #include <QtNetwork>
-#include <QJSEngine>
-#include <QJSValue>
 
 namespace {
 static const QString jsNameChars = "a-zA-Z0-9\\$_";
+
+static const QStringList elTypes = QStringList() << "&el=embedded" << "&el=detailpage" << "&el=vevo" << "";
+// one for each elTypes plus the special embedded request
+static const int variantCount = 5;
+// get_video_info requests in flight at once
+static const int maxParallelVariants = 3;
+
+// race outcomes per variant, kept in memory and saved on quit
+struct VariantStats {
+    QVector<int> attempts;
+    QVector<int> wins;
+};
+
+VariantStats &variantStats() {
+    static VariantStats stats = [] {
+        VariantStats stats;
+        stats.attempts.fill(0, variantCount);
+        stats.wins.fill(0, variantCount);
+        QSettings settings;
+        const QStringList attempts = settings.value("videoInfoVariantAttempts").toStringList();
+        const QStringList wins = settings.value("videoInfoVariantHits").toStringList();
+        for (int i = 0; i < variantCount; ++i) {
+            if (i < wins.size()) stats.wins[i] = wins.at(i).toInt();
+            if (i < attempts.size()) stats.attempts[i] = attempts.at(i).toInt();
+            // older settings only have the wins
+            stats.attempts[i] = qMax(stats.attempts.at(i), stats.wins.at(i));
+        }
+        return stats;
+    }();
+    return stats;
+}
+
+void recordVariantResult(int variant, bool won) {
+    VariantStats &stats = variantStats();
+    // halve old counts now and then, so a variant that stops working drops quickly
+    static const int maxAttempts = 200;
+    if (++stats.attempts[variant] > maxAttempts) {
+        for (int i = 0; i < variantCount; ++i) {
+            stats.attempts[i] /= 2;
+            stats.wins[i] /= 2;
+        }
+    }
+    if (won) stats.wins[variant]++;
+}
+
+// success rate, smoothed so that variants with no attempts still get raced
+double variantScore(int variant) {
+    const VariantStats &stats = variantStats();
+    return (stats.wins.at(variant) + 1.) / (stats.attempts.at(variant) + 2.);
+}
+
+bool variantLessThan(int a, int b) {
+    return variantScore(a) > variantScore(b);
+}
+
+// best success rate first, ties keep the original order
+QList<int> variantOrder() {
+    QList<int> order;
+    for (int i = 0; i < variantCount; ++i) order << i;
+    std::stable_sort(order.begin(), order.end(), variantLessThan);
+    return order;
+}
+
+}
+
+Video::Video() :
+    definitionCode(0),
+    elIndex(0),
+    ageGate(false),
+    loadingStreamUrl(false),
+    loadingThumbnail(false),
+    refreshTimer(0) {
 }
 
-Video::Video() : m_duration(0),
-    m_viewCount(-1),
-    m_license(LicenseYouTube),
+Video::Video(const VideoRecord &record) :
+    m_record(record),
     definitionCode(0),
     elIndex(0),
     ageGate(false),
     loadingStreamUrl(false),
-    loadingThumbnail(false) {
+    loadingThumbnail(false),
+    refreshTimer(0) {
 }
 
 Video* Video::clone() {
-    Video* cloneVideo = new Video();
-    cloneVideo->m_title = m_title;
-    cloneVideo->m_description = m_description;
-    cloneVideo->m_channelTitle = m_channelTitle;
-    cloneVideo->m_channelId = m_channelId;
-    cloneVideo->m_webpage = m_webpage;
+    Video* cloneVideo = new Video(m_record);
     cloneVideo->m_streamUrl = m_streamUrl;
     cloneVideo->m_thumbnail = m_thumbnail;
-    cloneVideo->m_thumbnailUrl = m_thumbnailUrl;
-    cloneVideo->m_mediumThumbnailUrl = m_mediumThumbnailUrl;
-    cloneVideo->m_duration = m_duration;
-    cloneVideo->m_published = m_published;
-    cloneVideo->m_viewCount = m_viewCount;
-    cloneVideo->videoId = videoId;
     cloneVideo->videoToken = videoToken;
     cloneVideo->definitionCode = definitionCode;
     return cloneVideo;
 }
 
 const QString &Video::webpage() {
-    if (m_webpage.isEmpty() && !videoId.isEmpty())
-        m_webpage.append("https://www.youtube.com/watch?v=").append(videoId);
-    return m_webpage;
+    if (m_record.webpage().isEmpty() && !m_record.id().isEmpty())
+        m_record.setWebpage("https://www.youtube.com/watch?v=" + m_record.id());
+    return m_record.webpage();
 }
 
 void Video::setWebpage(const QString &value) {
-    m_webpage = value;
+    m_record.setWebpage(value);
 
     // Get Video ID
-    if (videoId.isEmpty()) {
+    if (m_record.id().isEmpty()) {
         QRegExp re(JsFunctions::instance()->videoIdRE());
-        if (re.indexIn(m_webpage) == -1) {
-            qWarning() << QString("Cannot get video id for %1").arg(m_webpage);
+        if (re.indexIn(value) == -1) {
+            qWarning() << QString("Cannot get video id for %1").arg(value);
             // emit errorStreamUrl(QString("Cannot get video id for %1").arg(m_webpage.toString()));
             // loadingStreamUrl = false;
             return;
         }
-        videoId = re.cap(1);
+        m_record.setId(re.cap(1));
     }
 }
 
 void Video::loadThumbnail() {
-    if (m_thumbnailUrl.isEmpty() || loadingThumbnail) return;
+    if (m_record.thumbnailUrl().isEmpty() || loadingThumbnail) return;
     loadingThumbnail = true;
-    QObject *reply = HttpUtils::yt().get(m_thumbnailUrl);
+    // Videos are only created for rows being painted, so this is a visible
+    // thumbnail: after API pages and stream URLs, before background checks
+    QObject *reply = HttpUtils::yt().get(m_record.thumbnailUrl(), HttpRequest::ThumbnailPriority);
     connect(reply, SIGNAL(data(QByteArray)), SLOT(setThumbnail(QByteArray)));
 }
 
@@ -111,48 +175,169 @@ void Video::loadStreamUrl() {
         return;
     }
     loadingStreamUrl = true;
+
+    const QString definitionName = QSettings().value("definition", "360p").toString();
+    StreamUrlCache::Entry entry;
+    if (StreamUrlCache::lookup(m_record.id(), definitionName, entry)) {
+        m_streamUrl = entry.url;
+        definitionCode = entry.definitionCode;
+        scheduleRefresh(entry.expires);
+        // callers connect to gotStreamUrl() right before calling us
+        QTimer::singleShot(0, this, SLOT(emitCachedStreamUrl()));
+        return;
+    }
+
+    resolveStreamUrl();
+}
+
+void Video::reloadStreamUrl() {
+    if (loadingStreamUrl) {
+        qDebug() << "Already loading stream URL for" << this->title();
+        return;
+    }
+    StreamUrlCache::remove(m_record.id());
+    loadStreamUrl();
+}
+
+void Video::emitCachedStreamUrl() {
+    loadingStreamUrl = false;
+    emit gotStreamUrl(m_streamUrl);
+}
+
+void Video::scheduleRefresh(uint expires) {
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    const uint due = expires - StreamUrlCache::refreshMargin;
+    if (!refreshTimer) {
+        refreshTimer = new QTimer(this);
+        refreshTimer->setSingleShot(true);
+        connect(refreshTimer, SIGNAL(timeout()), SLOT(refreshStreamUrl()));
+    }
+    refreshTimer->start(due > now ? int(qMin<uint>(due - now, INT_MAX / 1000)) * 1000 : 0);
+}
+
+void Video::refreshStreamUrl() {
+    if (loadingStreamUrl) return;
+
+    // another Video with the same id may have refreshed it already
+    const QString definitionName = QSettings().value("definition", "360p").toString();
+    StreamUrlCache::Entry entry;
+    if (StreamUrlCache::lookup(m_record.id(), definitionName, entry)) {
+        m_streamUrl = entry.url;
+        definitionCode = entry.definitionCode;
+        return;
+    }
+
+    // a throwaway copy does the work, whoever listens to us is not bothered
+    qDebug() << "Refreshing stream URL for" << title();
+    Video *resolver = new Video(m_record);
+    resolver->setParent(this);
+    connect(resolver, SIGNAL(gotStreamUrl(QUrl)), SLOT(streamUrlRefreshed(QUrl)));
+    connect(resolver, SIGNAL(errorStreamUrl(QString)), resolver, SLOT(deleteLater()));
+    resolver->resolveStreamUrl();
+}
+
+void Video::streamUrlRefreshed(const QUrl &streamUrl) {
+    Video *resolver = static_cast<Video*>(sender());
+    m_streamUrl = streamUrl;
+    definitionCode = resolver->getDefinitionCode();
+    resolver->deleteLater();
+    // no further refreshes unless the video gets played again
+}
+
+void Video::resolveStreamUrl() {
+    loadingStreamUrl = true;
     elIndex = 0;
     ageGate = false;
 
-    getVideoInfo();
+    // Race the variants instead of waiting for each one to fail in turn
+    cancelVariants();
+    variantSequence = variantOrder();
+    pendingVariants = variantSequence;
+    for (int i = 0; i < maxParallelVariants; ++i)
+        if (!requestVariant()) break;
 }
 
-void  Video::getVideoInfo() {
-    static const QStringList elTypes = QStringList() << "&el=embedded" << "&el=detailpage" << "&el=vevo" << "";
-
+QUrl Video::videoInfoUrl(int variant) const {
     QUrl url;
-    if (elIndex == elTypes.size()) {
+    if (variant == elTypes.size()) {
         // qDebug() << "Trying special embedded el param";
         url = QUrl("https://www.youtube.com/get_video_info");
         QUrlQuery q;
-        q.addQueryItem("video_id", videoId);
+        q.addQueryItem("video_id", m_record.id());
         q.addQueryItem("el", "embedded");
         q.addQueryItem("gl", "US");
         q.addQueryItem("hl", "en");
-        q.addQueryItem("eurl", "https://youtube.googleapis.com/v/" + videoId);
+        q.addQueryItem("eurl", "https://youtube.googleapis.com/v/" + m_record.id());
         q.addQueryItem("asv", "3");
         q.addQueryItem("sts", "1588");
         url.setQuery(q);
-    } else if (elIndex > elTypes.size() - 1) {
+    } else {
+        // qDebug() << "Trying el param:" << elTypes.at(variant) << variant;
+        url = QUrl(QString(
+                       "https://www.youtube.com/get_video_info?video_id=%1%2&ps=default&eurl=&gl=US&hl=en"
+                       ).arg(m_record.id(), elTypes.at(variant)));
+    }
+    return url;
+}
+
+void  Video::getVideoInfo() {
+    if (elIndex < 0 || elIndex >= variantSequence.size()) {
         qWarning() << "Cannot get video info";
         loadingStreamUrl = false;
         emit errorStreamUrl("Cannot get video info");
         return;
-    } else {
-        // qDebug() << "Trying el param:" << elTypes.at(elIndex) << elIndex;
-        url = QUrl(QString(
-                       "https://www.youtube.com/get_video_info?video_id=%1%2&ps=default&eurl=&gl=US&hl=en"
-                       ).arg(videoId, elTypes.at(elIndex)));
     }
 
-    QObject *reply = HttpUtils::yt().get(url);
+    QObject *reply = HttpUtils::yt().get(videoInfoUrl(variantSequence.at(elIndex)));
     connect(reply, SIGNAL(data(QByteArray)), SLOT(gotVideoInfo(QByteArray)));
     connect(reply, SIGNAL(error(QString)), SLOT(errorVideoInfo(QString)));
 
     // see you in gotVideoInfo...
 }
 
+bool Video::requestVariant() {
+    if (pendingVariants.isEmpty()) return false;
+    const int variant = pendingVariants.takeFirst();
+    QObject *reply = HttpUtils::yt().get(videoInfoUrl(variant), HttpRequest::HighPriority);
+    variantReplies.insert(reply, variant);
+    connect(reply, SIGNAL(data(QByteArray)), SLOT(gotVideoInfo(QByteArray)));
+    connect(reply, SIGNAL(error(QString)), SLOT(errorVariant(QString)));
+    return true;
+}
+
+void Video::errorVariant(const QString &message) {
+    const int variant = variantReplies.take(sender());
+    qDebug() << "Variant failed" << variant << message;
+    recordVariantResult(variant, false);
+    nextVideoInfo(true);
+}
+
+void Video::nextVideoInfo(bool racing) {
+    if (!racing) {
+        elIndex++;
+        getVideoInfo();
+        return;
+    }
+
+    // the others may still make it
+    if (requestVariant() || !variantReplies.isEmpty()) return;
+    qWarning() << "Cannot get video info";
+    loadingStreamUrl = false;
+    emit errorStreamUrl("Cannot get video info");
+}
+
+void Video::cancelVariants() {
+    // their replies can't be aborted but are ignored from now on
+    foreach (QObject *reply, variantReplies.keys())
+        disconnect(reply, 0, this, 0);
+    variantReplies.clear();
+    pendingVariants.clear();
+}
+
 void  Video::gotVideoInfo(const QByteArray &bytes) {
+    const bool racing = variantReplies.contains(sender());
+    const int variant = racing ? variantReplies.take(sender()) : -1;
+
     QString videoInfo = QString::fromUtf8(bytes);
     // qDebug() << "videoInfo" << videoInfo;
 
@@ -161,28 +346,35 @@ void  Video::gotVideoInfo(const QByteArray &bytes) {
     if (videoTokeRE.indexIn(videoInfo) == -1) {
         qDebug() << "Cannot get token. Trying next el param" << videoInfo << videoTokeRE.pattern();
         // Don't panic! We're gonna try another magic "el" param
-        elIndex++;
-        getVideoInfo();
+        if (racing) recordVariantResult(variant, false);
+        nextVideoInfo(racing);
         return;
     }
 
-    QString videoToken = videoTokeRE.cap(1);
-    qDebug() << "got token" << videoToken;
-    while (videoToken.contains('%'))
-        videoToken = QByteArray::fromPercentEncoding(videoToken.toLatin1());
-    qDebug() << "videoToken" << videoToken;
-    this->videoToken = videoToken;
-
     // get fmt_url_map
     QRegExp fmtMapRE(JsFunctions::instance()->videoInfoFmtMapRE());
     if (fmtMapRE.indexIn(videoInfo) == -1) {
         qDebug() << "Cannot get urlMap. Trying next el param";
         // Don't panic! We're gonna try another magic "el" param
-        elIndex++;
-        getVideoInfo();
+        if (racing) recordVariantResult(variant, false);
+        nextVideoInfo(racing);
         return;
     }
 
+    if (racing) {
+        // first one with both wins, fallbacks continue after it in race order
+        cancelVariants();
+        recordVariantResult(variant, true);
+        elIndex = variantSequence.indexOf(variant);
+    }
+
+    QString videoToken = videoTokeRE.cap(1);
+    qDebug() << "got token" << videoToken;
+    while (videoToken.contains('%'))
+        videoToken = QByteArray::fromPercentEncoding(videoToken.toLatin1());
+    qDebug() << "videoToken" << videoToken;
+    this->videoToken = videoToken;
+
     QString fmtUrlMap = fmtMapRE.cap(1);
     // qDebug() << "got fmtUrlMap" << fmtUrlMap;
     fmtUrlMap = QByteArray::fromPercentEncoding(fmtUrlMap.toUtf8());
@@ -196,60 +388,38 @@ void Video::parseFmtUrlMap(const QString &fmtUrlMap, bool fromWebPage) {
     const VideoDefinition& definition = VideoDefinition::getDefinitionFor(definitionName);
 
     qDebug() << "fmtUrlMap" << fmtUrlMap;
-    const QStringList formatUrls = fmtUrlMap.split(',', QString::SkipEmptyParts);
     QHash<int, QString> urlMap;
-    foreach(const QString &formatUrl, formatUrls) {
-        // qDebug() << "formatUrl" << formatUrl;
-        const QStringList urlParams = formatUrl.split('&', QString::SkipEmptyParts);
-        // qDebug() << "urlParams" << urlParams;
-
-        int format = -1;
-        QString url;
-        QString sig;
-        foreach(const QString &urlParam, urlParams) {
-            // qWarning() << urlParam;
-            if (urlParam.startsWith("itag=")) {
-                int separator = urlParam.indexOf("=");
-                format = urlParam.mid(separator + 1).toInt();
-            } else if (urlParam.startsWith("url=")) {
-                int separator = urlParam.indexOf("=");
-                url = urlParam.mid(separator + 1);
-                url = QByteArray::fromPercentEncoding(url.toUtf8());
-            } else if (urlParam.startsWith("sig=")) {
-                int separator = urlParam.indexOf("=");
-                sig = urlParam.mid(separator + 1);
-                sig = QByteArray::fromPercentEncoding(sig.toUtf8());
-            } else if (urlParam.startsWith("s=")) {
-                if (fromWebPage || ageGate) {
-                    int separator = urlParam.indexOf("=");
-                    sig = urlParam.mid(separator + 1);
-                    sig = QByteArray::fromPercentEncoding(sig.toUtf8());
-                    if (ageGate)
-                        sig = JsFunctions::instance()->decryptAgeSignature(sig);
-                    else {
-                        sig = decryptSignature(sig);
-                        if (sig.isEmpty())
-                            sig = JsFunctions::instance()->decryptSignature(sig);
-                    }
-                } else {
-
-                    QUrl url("https://www.youtube.com/watch");
-                    QUrlQuery q;
-                    q.addQueryItem("v", videoId);
-                    q.addQueryItem("gl", "US");
-                    q.addQueryItem("hl", "en");
-                    q.addQueryItem("has_verified", "1");
-                    url.setQuery(q);
-                    qDebug() << "Loading webpage" << url;
-                    QObject *reply = HttpUtils::yt().get(url);
-                    connect(reply, SIGNAL(data(QByteArray)), SLOT(scrapeWebPage(QByteArray)));
-                    connect(reply, SIGNAL(error(QString)), SLOT(errorVideoInfo(QString)));
-                    // see you in scrapWebPage(QByteArray)
-                    return;
+
+    foreach (const FmtUrlMap::Format &format, FmtUrlMap::parse(fmtUrlMap)) {
+        QString url = format.url;
+        QString sig = format.sig;
+        if (format.encrypted) {
+            if (fromWebPage || ageGate) {
+                if (ageGate)
+                    sig = JsFunctions::instance()->decryptAgeSignature(format.sig);
+                else {
+                    sig = decryptSignature(format.sig);
+                    if (sig.isEmpty())
+                        sig = JsFunctions::instance()->decryptSignature(format.sig);
                 }
+            } else {
+
+                QUrl url("https://www.youtube.com/watch");
+                QUrlQuery q;
+                q.addQueryItem("v", m_record.id());
+                q.addQueryItem("gl", "US");
+                q.addQueryItem("hl", "en");
+                q.addQueryItem("has_verified", "1");
+                url.setQuery(q);
+                qDebug() << "Loading webpage" << url;
+                QObject *reply = HttpUtils::yt().get(url);
+                connect(reply, SIGNAL(data(QByteArray)), SLOT(scrapeWebPage(QByteArray)));
+                connect(reply, SIGNAL(error(QString)), SLOT(errorVideoInfo(QString)));
+                // see you in scrapWebPage(QByteArray)
+                return;
             }
         }
-        if (format == -1 || url.isNull()) continue;
+        if (format.itag == -1 || url.isEmpty()) continue;
 
         url += "&signature=" + sig;
 
@@ -258,13 +428,13 @@ void Video::parseFmtUrlMap(const QString &fmtUrlMap, bool fromWebPage) {
 
         qDebug() << url;
 
-        if (format == definition.getCode()) {
+        if (format.itag == definition.getCode()) {
             qDebug() << "Found format" << definitionCode;
             saveDefinitionForUrl(url, definition);
             return;
         }
 
-        urlMap.insert(format, url);
+        urlMap.insert(format.itag, url);
     }
 
     const QList<VideoDefinition>& definitions = VideoDefinition::getDefinitions();
@@ -279,7 +449,7 @@ void Video::parseFmtUrlMap(const QString &fmtUrlMap, bool fromWebPage) {
         }
     }
 
-    emit errorStreamUrl(tr("Cannot get video stream for %1").arg(m_webpage));
+    emit errorStreamUrl(tr("Cannot get video stream for %1").arg(webpage()));
 }
 
 void Video::errorVideoInfo(const QString &message) {
@@ -294,7 +464,8 @@ void Video::scrapeWebPage(const QByteArray &bytes) {
     if (ageGateRE.indexIn(html) != -1) {
         // qDebug() << "Found ageGate";
         ageGate = true;
-        elIndex = 4;
+        // the special embedded request
+        elIndex = variantSequence.indexOf(elTypes.size());
         getVideoInfo();
         return;
     }
@@ -340,6 +511,12 @@ void Video::scrapeWebPage(const QByteArray &bytes) {
                     jsPlayerIdRe.indexIn(jsPlayerUrl);
                     QString jsPlayerId = jsPlayerRe.cap(1);
                     */
+        this->jsPlayerUrl = jsPlayerUrl;
+        if (PlayerDecipher::instance().isReady(jsPlayerUrl)) {
+            // same player as last time, no need to fetch and parse it again
+            jsPlayerReady();
+            return;
+        }
         QObject *reply = HttpUtils::yt().get(jsPlayerUrl);
         connect(reply, SIGNAL(data(QByteArray)), SLOT(parseJsPlayer(QByteArray)));
         connect(reply, SIGNAL(error(QString)), SLOT(errorVideoInfo(QString)));
@@ -359,8 +536,15 @@ void Video::parseJsPlayer(const QByteArray &bytes) {
         sigFuncName = funcNameRe.cap(1);
         captureFunction(sigFuncName, js);
         // qWarning() << sigFunctions << sigObjects;
+        // objects first, the functions refer to them
+        PlayerDecipher::instance().compile(jsPlayerUrl, sigFuncName,
+                                           sigObjects.values() + sigFunctions.values());
     }
 
+    jsPlayerReady();
+}
+
+void Video::jsPlayerReady() {
 #ifdef APP_DASH
     if (!dashManifestUrl.isEmpty()) {
         QRegExp sigRe("/s/([\\w\\.]+)");
@@ -462,39 +646,43 @@ void Video::captureObject(const QString &name, const QString &js) {
 }
 
 QString Video::decryptSignature(const QString &s) {
-    if (sigFuncName.isEmpty()) return QString();
-    QJSEngine engine;
-    foreach (const QString &f, sigObjects.values()) {
-        QJSValue value = engine.evaluate(f);
-        if (value.isError())
-            qWarning() << "Error in" << f << value.toString();
-    }
-    foreach (const QString &f, sigFunctions.values()) {
-        QJSValue value = engine.evaluate(f);
-        if (value.isError())
-            qWarning() << "Error in" << f << value.toString();
-    }
-    QString js = sigFuncName + "('" + s + "');";
-    QJSValue value = engine.evaluate(js);
-    if (value.isUndefined()) {
-        qWarning() << "Undefined result for" << js;
-        return QString();
-    }
-    if (value.isError()) {
-        qWarning() << "Error in" << js << value.toString();
-        return QString();
+    PlayerDecipher &decipher = PlayerDecipher::instance();
+    if (!decipher.isReady(jsPlayerUrl)) return QString();
+    return decipher.decipher(s);
+}
+
+// static
+void Video::saveVariantStats() {
+    const VariantStats &stats = variantStats();
+    QStringList attempts, wins;
+    for (int i = 0; i < variantCount; ++i) {
+        attempts << QString::number(stats.attempts.at(i));
+        wins << QString::number(stats.wins.at(i));
     }
-    return value.toString();
+    QSettings settings;
+    settings.setValue("videoInfoVariantAttempts", attempts);
+    settings.setValue("videoInfoVariantHits", wins);
+}
+
+void Video::setDetails(int duration, int viewCount) {
+    m_record.setDuration(duration);
+    m_record.setViewCount(viewCount);
+    emit detailsChanged();
 }
 
 QString Video::formattedDuration() const {
-    return DataUtils::formatDuration(m_duration);
+    return DataUtils::formatDuration(m_record.duration());
 }
 
 void Video::saveDefinitionForUrl(const QString& url, const VideoDefinition& definition) {
     const QUrl videoUrl = QUrl::fromEncoded(url.toUtf8(), QUrl::StrictMode);
     m_streamUrl = videoUrl;
     definitionCode = definition.getCode();
+
+    const QString definitionName = QSettings().value("definition", "360p").toString();
+    StreamUrlCache::store(m_record.id(), definitionName, videoUrl, definitionCode);
+    scheduleRefresh(StreamUrlCache::expiryOf(videoUrl));
+
     emit gotStreamUrl(videoUrl);
     loadingStreamUrl = false;
 }
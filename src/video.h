@@ -23,6 +23,7 @@ $END_LICENSE */
 
 #include <QtWidgets>
 #include <QtNetwork>
+#include "videorecord.h"
 
 class VideoDefinition;
 
@@ -32,24 +33,28 @@ class Video : public QObject {
 
 public:
     Video();
+    Video(const VideoRecord &record);
     Video* clone();
 
     enum License {
-        LicenseYouTube = 1,
-        LicenseCC
+        LicenseYouTube = VideoRecord::LicenseYouTube,
+        LicenseCC = VideoRecord::LicenseCC
     };
 
-    const QString &title() const { return m_title; }
-    void setTitle(const QString &value) { m_title = value; }
+    // metadata, shared with the source that created this video
+    const VideoRecord &record() const { return m_record; }
 
-    const QString &description() const { return m_description; }
-    void setDescription(const QString &value) { m_description = value; }
+    const QString &title() const { return m_record.title(); }
+    void setTitle(const QString &value) { m_record.setTitle(value); }
 
-    const QString &channelTitle() const { return m_channelTitle; }
-    void setChannelTitle(const QString &value) { m_channelTitle = value; }
+    const QString &description() const { return m_record.description(); }
+    void setDescription(const QString &value) { m_record.setDescription(value); }
 
-    const QString &channelId() const { return m_channelId; }
-    void setChannelId(const QString &value ) { m_channelId = value; }
+    const QString &channelTitle() const { return m_record.channelTitle(); }
+    void setChannelTitle(const QString &value) { m_record.setChannelTitle(value); }
+
+    const QString &channelId() const { return m_record.channelId(); }
+    void setChannelId(const QString &value ) { m_record.setChannelId(value); }
 
     const QString &webpage();
     void setWebpage(const QString &value);
@@ -57,38 +62,48 @@ public:
     void loadThumbnail();
     const QPixmap &thumbnail() const { return m_thumbnail; }
 
-    const QString &thumbnailUrl() { return m_thumbnailUrl; }
-    void setThumbnailUrl(const QString &value) { m_thumbnailUrl = value; }
+    const QString &thumbnailUrl() { return m_record.thumbnailUrl(); }
+    void setThumbnailUrl(const QString &value) { m_record.setThumbnailUrl(value); }
 
-    const QString &mediumThumbnailUrl() { return m_mediumThumbnailUrl; }
-    void setMediumThumbnailUrl(const QString &value) { m_mediumThumbnailUrl = value; }
+    const QString &mediumThumbnailUrl() { return m_record.mediumThumbnailUrl(); }
+    void setMediumThumbnailUrl(const QString &value) { m_record.setMediumThumbnailUrl(value); }
 
-    const QString &largeThumbnailUrl() { return m_largeThumbnailUrl; }
-    void setLargeThumbnailUrl(const QString &value) { m_largeThumbnailUrl = value; }
+    const QString &largeThumbnailUrl() { return m_record.largeThumbnailUrl(); }
+    void setLargeThumbnailUrl(const QString &value) { m_record.setLargeThumbnailUrl(value); }
 
-    int duration() const { return m_duration; }
-    void setDuration(int value) { m_duration = value; }
+    int duration() const { return m_record.duration(); }
+    void setDuration(int value) { m_record.setDuration(value); }
     QString formattedDuration() const;
 
-    int viewCount() const { return m_viewCount; }
-    void setViewCount(int viewCount) { m_viewCount = viewCount; }
+    int viewCount() const { return m_record.viewCount(); }
+    void setViewCount(int viewCount) { m_record.setViewCount(viewCount); }
+
+    const QDateTime &published() const { return m_record.published(); }
+    void setPublished(const QDateTime &value) { m_record.setPublished(value); }
 
-    const QDateTime &published() const { return m_published; }
-    void setPublished(const QDateTime &value) { m_published = value; }
+    // for details that arrive after the video was handed out
+    void setDetails(int duration, int viewCount);
+
+    // get_video_info variant statistics are only written by this
+    static void saveVariantStats();
 
     int getDefinitionCode() const { return definitionCode; }
 
+    // served from StreamUrlCache when possible
     void loadStreamUrl();
+    // resolves again, for stream URLs that turned out not to work
+    void reloadStreamUrl();
     const QUrl &getStreamUrl() { return m_streamUrl; }
 
-    void setId(const QString &value) { videoId = value; }
-    const QString &id() const { return videoId; }
+    void setId(const QString &value) { m_record.setId(value); }
+    const QString &id() const { return m_record.id(); }
 
-    void setLicense(License value) { m_license = value; }
-    License license() const { return m_license; }
+    void setLicense(License value) { m_record.setLicense(VideoRecord::License(value)); }
+    License license() const { return License(m_record.license()); }
 
 signals:
     void gotThumbnail();
+    void detailsChanged();
     void gotMediumThumbnail(const QByteArray &bytes);
     void gotLargeThumbnail(const QByteArray &bytes);
     void gotStreamUrl(const QUrl &streamUrl);
@@ -98,45 +113,53 @@ private slots:
     void setThumbnail(const QByteArray &bytes);
     void gotVideoInfo(const QByteArray &bytes);
     void errorVideoInfo(const QString &message);
+    void errorVariant(const QString &message);
     void scrapeWebPage(const QByteArray &bytes);
     void parseJsPlayer(const QByteArray &bytes);
+    void jsPlayerReady();
     void parseDashManifest(const QByteArray &bytes);
+    void emitCachedStreamUrl();
+    void refreshStreamUrl();
+    void streamUrlRefreshed(const QUrl &streamUrl);
 
 private:
+    void resolveStreamUrl();
+    void scheduleRefresh(uint expires);
     void getVideoInfo();
+    QUrl videoInfoUrl(int variant) const;
+    bool requestVariant();
+    void nextVideoInfo(bool racing);
+    void cancelVariants();
     void parseFmtUrlMap(const QString &fmtUrlMap, bool fromWebPage = false);
     void captureFunction(const QString &name, const QString &js);
     void captureObject(const QString &name, const QString &js);
     QString decryptSignature(const QString &s);
     void saveDefinitionForUrl(const QString &url, const VideoDefinition &definition);
 
-    QString m_title;
-    QString m_description;
-    QString m_channelTitle;
-    QString m_channelId;
-    QString m_webpage;
+    VideoRecord m_record;
     QUrl m_streamUrl;
     QPixmap m_thumbnail;
-    QString m_thumbnailUrl;
-    QString m_mediumThumbnailUrl;
-    QString m_largeThumbnailUrl;
-    int m_duration;
-    QDateTime m_published;
-    int m_viewCount;
-    License m_license;
-    QString videoId;
     QString videoToken;
     int definitionCode;
 
-    // current index for the elTypes list
-    // needed to iterate on elTypes
+    // position in variantSequence of the get_video_info variant being tried
     int elIndex;
     bool ageGate;
+
+    // get_video_info variants raced by loadStreamUrl(), by reply
+    QHash<QObject*, int> variantReplies;
+    QList<int> pendingVariants;
+    // all variants in race order, for the sequential fallbacks
+    QList<int> variantSequence;
     
     bool loadingStreamUrl;
     bool loadingThumbnail;
+    // re-resolves the stream URL before it expires
+    QTimer *refreshTimer;
 
     QString fmtUrlMap;
+    // identifies the js player and its signature functions
+    QString jsPlayerUrl;
     QString sigFuncName;
     QHash<QString, QString> sigFunctions;
     QHash<QString, QString> sigObjects;
@@ -0,0 +1,98 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "videodetailscache.h"
+#include "videorecord.h"
+#include "database.h"
+#include <QtSql>
+
+QHash<QString, VideoDetailsCache::Entry> VideoDetailsCache::lookup(const QStringList &videoIds) {
+    QHash<QString, Entry> entries;
+    if (videoIds.isEmpty()) return entries;
+
+    // one cached statement and a primary key lookup per id
+    QSqlQuery query = Database::instance().cachedQuery(
+                "select duration,views,fetched,etag from video_details where video_id=?");
+    foreach (const QString &videoId, videoIds) {
+        query.bindValue(0, videoId);
+        if (!query.exec()) {
+            qWarning() << query.lastQuery() << query.lastError().text();
+            break;
+        }
+        if (!query.next()) continue;
+        Entry entry;
+        entry.duration = query.value(0).toInt();
+        entry.viewCount = query.value(1).toInt();
+        entry.fetched = query.value(2).toUInt();
+        entry.etag = query.value(3).toByteArray();
+        entries.insert(videoId, entry);
+        query.finish();
+    }
+    return entries;
+}
+
+void VideoDetailsCache::store(const QVector<VideoRecord> &records, const QByteArray &etag) {
+    if (records.isEmpty()) return;
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    QVariantList ids, durations, views, fetched, etags;
+    foreach (const VideoRecord &record, records) {
+        ids << record.id();
+        durations << record.duration();
+        views << record.viewCount();
+        fetched << now;
+        etags << QString::fromLatin1(etag);
+    }
+
+    QSqlQuery query = Database::instance().cachedQuery(
+                "insert or replace into video_details (video_id,duration,views,fetched,etag) "
+                "values (?,?,?,?,?)");
+    query.bindValue(0, ids);
+    query.bindValue(1, durations);
+    query.bindValue(2, views);
+    query.bindValue(3, fetched);
+    query.bindValue(4, etags);
+    if (!query.execBatch()) qWarning() << query.lastQuery() << query.lastError().text();
+}
+
+void VideoDetailsCache::touch(const QStringList &videoIds) {
+    if (videoIds.isEmpty()) return;
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    QVariantList ids, fetched;
+    foreach (const QString &videoId, videoIds) {
+        ids << videoId;
+        fetched << now;
+    }
+
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update video_details set fetched=? where video_id=?");
+    query.bindValue(0, fetched);
+    query.bindValue(1, ids);
+    if (!query.execBatch()) qWarning() << query.lastQuery() << query.lastError().text();
+}
+
+void VideoDetailsCache::prune() {
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    QSqlQuery query(Database::instance().getConnection());
+    query.prepare(Database::pruneDetailsSql);
+    query.bindValue(0, now - pruneAge);
+    if (!query.exec()) qWarning() << query.lastQuery() << query.lastError().text();
+}
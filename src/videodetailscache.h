@@ -0,0 +1,61 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef VIDEODETAILSCACHE_H
+#define VIDEODETAILSCACHE_H
+
+#include <QtCore>
+
+class VideoRecord;
+
+/**
+  * Durations and view counts by video id, stored in the database.
+  * Duration never changes and view counts may be a few hours old,
+  * so known videos are left out of the details requests.
+  */
+class VideoDetailsCache {
+
+public:
+    struct Entry {
+        Entry() : duration(0), viewCount(-1), fetched(0) { }
+        int duration;
+        int viewCount;
+        uint fetched;
+        // of the response that delivered this entry, for If-None-Match
+        QByteArray etag;
+    };
+
+    // entries older than this are revalidated
+    static const uint maxAge = 6 * 60 * 60;
+    // entries older than this are deleted
+    static const uint pruneAge = 4 * maxAge;
+
+    static QHash<QString, Entry> lookup(const QStringList &videoIds);
+    static void store(const QVector<VideoRecord> &records, const QByteArray &etag);
+    // the server says nothing changed
+    static void touch(const QStringList &videoIds);
+    static void prune();
+
+private:
+    VideoDetailsCache() { }
+
+};
+
+#endif // VIDEODETAILSCACHE_H
@@ -0,0 +1,91 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "videorecord.h"
+
+class VideoRecordData : public QSharedData {
+
+public:
+    VideoRecordData() : duration(0), viewCount(-1), license(VideoRecord::LicenseYouTube) { }
+
+    QString id;
+    QString title;
+    QString description;
+    QString channelTitle;
+    QString channelId;
+    QString webpage;
+    QString thumbnailUrl;
+    QString mediumThumbnailUrl;
+    QString largeThumbnailUrl;
+    int duration;
+    int viewCount;
+    QDateTime published;
+    VideoRecord::License license;
+};
+
+VideoRecord::VideoRecord() : d(new VideoRecordData) { }
+
+VideoRecord::VideoRecord(const VideoRecord &other) : d(other.d) { }
+
+VideoRecord &VideoRecord::operator=(const VideoRecord &other) {
+    d = other.d;
+    return *this;
+}
+
+VideoRecord::~VideoRecord() { }
+
+const QString &VideoRecord::id() const { return d->id; }
+void VideoRecord::setId(const QString &value) { d->id = value; }
+
+const QString &VideoRecord::title() const { return d->title; }
+void VideoRecord::setTitle(const QString &value) { d->title = value; }
+
+const QString &VideoRecord::description() const { return d->description; }
+void VideoRecord::setDescription(const QString &value) { d->description = value; }
+
+const QString &VideoRecord::channelTitle() const { return d->channelTitle; }
+void VideoRecord::setChannelTitle(const QString &value) { d->channelTitle = value; }
+
+const QString &VideoRecord::channelId() const { return d->channelId; }
+void VideoRecord::setChannelId(const QString &value) { d->channelId = value; }
+
+const QString &VideoRecord::webpage() const { return d->webpage; }
+void VideoRecord::setWebpage(const QString &value) { d->webpage = value; }
+
+const QString &VideoRecord::thumbnailUrl() const { return d->thumbnailUrl; }
+void VideoRecord::setThumbnailUrl(const QString &value) { d->thumbnailUrl = value; }
+
+const QString &VideoRecord::mediumThumbnailUrl() const { return d->mediumThumbnailUrl; }
+void VideoRecord::setMediumThumbnailUrl(const QString &value) { d->mediumThumbnailUrl = value; }
+
+const QString &VideoRecord::largeThumbnailUrl() const { return d->largeThumbnailUrl; }
+void VideoRecord::setLargeThumbnailUrl(const QString &value) { d->largeThumbnailUrl = value; }
+
+int VideoRecord::duration() const { return d->duration; }
+void VideoRecord::setDuration(int value) { d->duration = value; }
+
+int VideoRecord::viewCount() const { return d->viewCount; }
+void VideoRecord::setViewCount(int value) { d->viewCount = value; }
+
+const QDateTime &VideoRecord::published() const { return d->published; }
+void VideoRecord::setPublished(const QDateTime &value) { d->published = value; }
+
+VideoRecord::License VideoRecord::license() const { return d->license; }
+void VideoRecord::setLicense(License value) { d->license = value; }
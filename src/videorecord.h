@@ -0,0 +1,93 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef VIDEORECORD_H
+#define VIDEORECORD_H
+
+#include <QtCore>
+
+class VideoRecordData;
+
+/**
+  * Video metadata as an implicitly shared value.
+  * Copies cost a reference count, so lists of records can be passed
+  * around and stored without creating a Video QObject per item.
+  */
+class VideoRecord {
+
+public:
+    enum License {
+        LicenseYouTube = 1,
+        LicenseCC
+    };
+
+    VideoRecord();
+    VideoRecord(const VideoRecord &other);
+    VideoRecord &operator=(const VideoRecord &other);
+    ~VideoRecord();
+
+    const QString &id() const;
+    void setId(const QString &value);
+
+    const QString &title() const;
+    void setTitle(const QString &value);
+
+    const QString &description() const;
+    void setDescription(const QString &value);
+
+    const QString &channelTitle() const;
+    void setChannelTitle(const QString &value);
+
+    const QString &channelId() const;
+    void setChannelId(const QString &value);
+
+    // empty unless set explicitly, see Video::webpage()
+    const QString &webpage() const;
+    void setWebpage(const QString &value);
+
+    const QString &thumbnailUrl() const;
+    void setThumbnailUrl(const QString &value);
+
+    const QString &mediumThumbnailUrl() const;
+    void setMediumThumbnailUrl(const QString &value);
+
+    const QString &largeThumbnailUrl() const;
+    void setLargeThumbnailUrl(const QString &value);
+
+    int duration() const;
+    void setDuration(int value);
+
+    int viewCount() const;
+    void setViewCount(int value);
+
+    const QDateTime &published() const;
+    void setPublished(const QDateTime &value);
+
+    License license() const;
+    void setLicense(License value);
+
+private:
+    QSharedDataPointer<VideoRecordData> d;
+
+};
+
+Q_DECLARE_TYPEINFO(VideoRecord, Q_MOVABLE_TYPE);
+
+#endif // VIDEORECORD_H
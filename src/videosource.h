@@ -23,8 +23,7 @@ $END_LICENSE */
 
 #include <QtCore>
 #include <QAction>
-
-class Video;
+#include "videorecord.h"
 
 class VideoSource : public QObject {
 
@@ -43,7 +42,11 @@ public slots:
     void setParam(const QString &name, const QVariant &value);
 
 signals:
-    void gotVideos(QList<Video*> videos);
+    // receivers create Video objects only for the records they need
+    void gotVideos(const QVector<VideoRecord> &videos);
+    // durations and view counts that arrived after gotVideos(),
+    // these records only have the id, duration and view count set
+    void gotDetails(const QVector<VideoRecord> &videos);
     void finished(int total);
     void error(QString message);
     void nameChanged(QString name);
@@ -42,15 +42,14 @@ void VideoSourceWidget::activate() {
     emit activated(videoSource);
 }
 
-void VideoSourceWidget::previewVideo(const QList<Video *> &videos) {
+void VideoSourceWidget::previewVideo(const QVector<VideoRecord> &videos) {
     videoSource->disconnect();
     if (videos.isEmpty()) return;
-    Video *video = videos.first();
+    const VideoRecord &video = videos.first();
     lastPixelRatio = window()->devicePixelRatio();
     bool needLargeThumb = lastPixelRatio > 1.0 || window()->width() > 2000;
-    QString url =  needLargeThumb ? video->largeThumbnailUrl() : video->mediumThumbnailUrl();
-    if (url.isEmpty()) url = video->mediumThumbnailUrl();
-    video->deleteLater();
+    QString url =  needLargeThumb ? video.largeThumbnailUrl() : video.mediumThumbnailUrl();
+    if (url.isEmpty()) url = video.mediumThumbnailUrl();
     QObject *reply = HttpUtils::yt().get(url);
     connect(reply, SIGNAL(data(QByteArray)), SLOT(setPixmapData(QByteArray)));
 }
@@ -62,8 +61,8 @@ void VideoSourceWidget::setPixmapData(const QByteArray &bytes) {
 }
 
 void VideoSourceWidget::loadPreview() {
-    connect(videoSource, SIGNAL(gotVideos(QList<Video*>)),
-            SLOT(previewVideo(QList<Video*>)), Qt::UniqueConnection);
+    connect(videoSource, SIGNAL(gotVideos(QVector<VideoRecord>)),
+            SLOT(previewVideo(QVector<VideoRecord>)), Qt::UniqueConnection);
     videoSource->loadVideos(1, 1);
 }
 
@@ -24,8 +24,8 @@ $END_LICENSE */
 #include <QtWidgets>
 
 #include "gridwidget.h"
+#include "videorecord.h"
 
-class Video;
 class VideoSource;
 
 class VideoSourceWidget : public GridWidget {
@@ -43,7 +43,7 @@ protected:
 
 private slots:
     void activate();
-    void previewVideo(const QList<Video*> &videos);
+    void previewVideo(const QVector<VideoRecord> &videos);
     void setPixmapData(const QByteArray &bytes);
 
 private:
@@ -1,15 +1,25 @@
 #include "yt3listparser.h"
 #include "video.h"
 #include "datautils.h"
+#include "jsonreader.h"
 
 YT3ListParser::YT3ListParser(const QByteArray &bytes) {
+    if (parseStream(bytes)) return;
+
+    // malformed or unexpected input, let QJsonDocument have a go
+    qWarning() << "Streaming parse failed, falling back to QJsonDocument";
+    records.clear();
+    nextPageToken.clear();
+    etag.clear();
+
     QJsonDocument doc = QJsonDocument::fromJson(bytes);
     QJsonObject obj = doc.object();
 
     nextPageToken = obj["nextPageToken"].toString();
+    etag = obj["etag"].toString();
 
     QJsonArray items = obj["items"].toArray();
-    videos.reserve(items.size());
+    records.reserve(items.size());
     foreach (const QJsonValue &v, items) {
         QJsonObject item = v.toObject();
         parseItem(item);
@@ -19,38 +29,42 @@ YT3ListParser::YT3ListParser(const QByteArray &bytes) {
 }
 
 void YT3ListParser::parseItem(const QJsonObject &item) {
-    Video *video = new Video();
+    VideoRecord video;
+
+    QJsonObject snippet = item["snippet"].toObject();
 
     QJsonValue id = item["id"];
-    if (id.isString()) video->setId(id.toString());
+    QJsonValue resourceId = snippet["resourceId"];
+    if (resourceId.isObject()) {
+        // playlistItems, id is the one of the item not of the video
+        video.setId(resourceId.toObject()["videoId"].toString());
+    } else if (id.isString()) video.setId(id.toString());
     else {
         QString videoId = id.toObject()["videoId"].toString();
-        video->setId(videoId);
+        video.setId(videoId);
     }
 
-    QJsonObject snippet = item["snippet"].toObject();
-
-    bool isLiveBroadcastContent = snippet["liveBroadcastContent"].toString() != QLatin1String("none");
-    if (isLiveBroadcastContent) {
-        delete video;
-        return;
-    }
+    // playlistItems snippets don't have liveBroadcastContent
+    QString liveBroadcastContent = snippet["liveBroadcastContent"].toString();
+    bool isLiveBroadcastContent = !liveBroadcastContent.isEmpty()
+            && liveBroadcastContent != QLatin1String("none");
+    if (isLiveBroadcastContent) return;
 
     QString publishedAt = snippet["publishedAt"].toString();
     QDateTime publishedDateTime = QDateTime::fromString(publishedAt, Qt::ISODate);
-    video->setPublished(publishedDateTime);
+    video.setPublished(publishedDateTime);
 
-    video->setChannelId(snippet["channelId"].toString());
+    video.setChannelId(snippet["channelId"].toString());
 
-    video->setTitle(snippet["title"].toString());
-    video->setDescription(snippet["description"].toString());
+    video.setTitle(snippet["title"].toString());
+    video.setDescription(snippet["description"].toString());
 
     QJsonObject thumbnails = snippet["thumbnails"].toObject();
-    video->setThumbnailUrl(thumbnails["medium"].toObject()["url"].toString());
-    video->setMediumThumbnailUrl(thumbnails["high"].toObject()["url"].toString());
-    video->setLargeThumbnailUrl(thumbnails["standard"].toObject()["url"].toString());
+    video.setThumbnailUrl(thumbnails["medium"].toObject()["url"].toString());
+    video.setMediumThumbnailUrl(thumbnails["high"].toObject()["url"].toString());
+    video.setLargeThumbnailUrl(thumbnails["standard"].toObject()["url"].toString());
 
-    video->setChannelTitle(snippet["channelTitle"].toString());
+    video.setChannelTitle(snippet["channelTitle"].toString());
 
     // These are only for "videos" requests
 
@@ -58,14 +72,127 @@ void YT3ListParser::parseItem(const QJsonObject &item) {
     if (contentDetails.isObject()) {
         QString isoPeriod = contentDetails.toObject()["duration"].toString();
         int duration = DataUtils::parseIsoPeriod(isoPeriod);
-        video->setDuration(duration);
+        video.setDuration(duration);
     }
 
     QJsonValue statistics = item["statistics"];
     if (statistics.isObject()) {
         int viewCount = statistics.toObject()["viewCount"].toString().toInt();
-        video->setViewCount(viewCount);
+        video.setViewCount(viewCount);
+    }
+
+    records.append(video);
+}
+
+bool YT3ListParser::parseStream(const QByteArray &bytes) {
+    JsonReader reader(bytes);
+    QByteArray key;
+    if (!reader.beginObject()) return false;
+    while (reader.nextKey(key)) {
+        if (key == "nextPageToken") nextPageToken = reader.readString();
+        else if (key == "etag") etag = reader.readString();
+        else if (key == "items" && reader.peek() == JsonReader::ArrayType) {
+            reader.beginArray();
+            while (reader.nextElement()) parseItem(reader);
+        } else reader.skipValue();
+    }
+    return !reader.hasError();
+}
+
+namespace {
+
+QString readUrl(JsonReader &reader) {
+    QString url;
+    QByteArray key;
+    if (reader.peek() != JsonReader::ObjectType) {
+        reader.skipValue();
+        return url;
+    }
+    reader.beginObject();
+    while (reader.nextKey(key)) {
+        if (key == "url") url = reader.readString();
+        else reader.skipValue();
+    }
+    return url;
+}
+
+// reads {"name": value} and returns value as a string, skipping other keys
+QString readField(JsonReader &reader, const char *name) {
+    QString value;
+    QByteArray key;
+    if (reader.peek() != JsonReader::ObjectType) {
+        reader.skipValue();
+        return value;
+    }
+    reader.beginObject();
+    while (reader.nextKey(key)) {
+        if (key == name) value = reader.readScalar();
+        else reader.skipValue();
+    }
+    return value;
+}
+
+}
+
+/**
+  * Same fields and rules as parseItem(const QJsonObject &),
+  * keys may come in any order.
+  */
+void YT3ListParser::parseItem(JsonReader &reader) {
+    VideoRecord video;
+    QString itemId;
+    QString resourceVideoId;
+    bool hasResourceId = false;
+    bool isLiveBroadcastContent = false;
+    QByteArray key;
+
+    if (reader.peek() != JsonReader::ObjectType) {
+        reader.skipValue();
+        return;
+    }
+    reader.beginObject();
+    while (reader.nextKey(key)) {
+        if (key == "id") {
+            if (reader.peek() == JsonReader::ObjectType)
+                itemId = readField(reader, "videoId");
+            else itemId = reader.readScalar();
+
+        } else if (key == "snippet" && reader.peek() == JsonReader::ObjectType) {
+            reader.beginObject();
+            while (reader.nextKey(key)) {
+                if (key == "publishedAt")
+                    video.setPublished(QDateTime::fromString(reader.readString(), Qt::ISODate));
+                else if (key == "channelId") video.setChannelId(reader.readString());
+                else if (key == "title") video.setTitle(reader.readString());
+                else if (key == "description") video.setDescription(reader.readString());
+                else if (key == "channelTitle") video.setChannelTitle(reader.readString());
+                else if (key == "liveBroadcastContent") {
+                    const QString value = reader.readString();
+                    isLiveBroadcastContent = !value.isEmpty() && value != QLatin1String("none");
+                } else if (key == "resourceId") {
+                    // playlistItems, id is the one of the item not of the video
+                    hasResourceId = reader.peek() == JsonReader::ObjectType;
+                    resourceVideoId = readField(reader, "videoId");
+                } else if (key == "thumbnails" && reader.peek() == JsonReader::ObjectType) {
+                    reader.beginObject();
+                    while (reader.nextKey(key)) {
+                        if (key == "medium") video.setThumbnailUrl(readUrl(reader));
+                        else if (key == "high") video.setMediumThumbnailUrl(readUrl(reader));
+                        else if (key == "standard") video.setLargeThumbnailUrl(readUrl(reader));
+                        else reader.skipValue();
+                    }
+                } else reader.skipValue();
+            }
+
+        // These are only for "videos" requests
+        } else if (key == "contentDetails" && reader.peek() == JsonReader::ObjectType) {
+            video.setDuration(DataUtils::parseIsoPeriod(readField(reader, "duration")));
+        } else if (key == "statistics" && reader.peek() == JsonReader::ObjectType) {
+            video.setViewCount(readField(reader, "viewCount").toInt());
+        } else reader.skipValue();
     }
 
-    videos.append(video);
+    if (reader.hasError() || isLiveBroadcastContent) return;
+    video.setId(hasResourceId ? resourceVideoId : itemId);
+    records.append(video);
 }
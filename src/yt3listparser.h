@@ -2,23 +2,45 @@
 #define YT3LISTPARSER_H
 
 #include <QtCore>
+#include "videorecord.h"
+#include "jsonparsetask.h"
 
-class Video;
+class JsonReader;
 
-class YT3ListParser : public QObject {
+class YT3ListParser {
 
 public:
     YT3ListParser(const QByteArray &bytes);
-    const QList<Video*> &getVideos() { return videos; }
-    const QStringList &getSuggestions() { return suggestions; }
-    const QString &getNextPageToken() { return nextPageToken; }
+    const QVector<VideoRecord> &getRecords() const { return records; }
+    const QStringList &getSuggestions() const { return suggestions; }
+    const QString &getNextPageToken() const { return nextPageToken; }
+    const QString &getEtag() const { return etag; }
 
 private:
+    bool parseStream(const QByteArray &bytes);
+    void parseItem(JsonReader &reader);
     void parseItem(const QJsonObject &item);
 
-    QList<Video*> videos;
+    QVector<VideoRecord> records;
     QStringList suggestions;
     QString nextPageToken;
+    QString etag;
+};
+
+// YT3ListParser on the parsing pool. Records are plain data, so they
+// can be handed to the receiver's thread as they are.
+class YT3ListParseTask : public JsonParseTask {
+
+public:
+    YT3ListParseTask(const QByteArray &bytes) : JsonParseTask(bytes) { }
+    const YT3ListParser &getParser() const { return *parser; }
+
+protected:
+    void parse(const QByteArray &bytes) { parser.reset(new YT3ListParser(bytes)); }
+
+private:
+    QScopedPointer<YT3ListParser> parser;
+
 };
 
 #endif // YT3LISTPARSER_H
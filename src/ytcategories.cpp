@@ -24,6 +24,7 @@ $END_LICENSE */
 #include "datautils.h"
 #include "yt3.h"
 #include "ytregions.h"
+#include "jsonparsetask.h"
 
 YTCategories::YTCategories(QObject *parent) : QObject(parent) { }
 
@@ -52,10 +53,16 @@ void YTCategories::loadCategories(QString language) {
 }
 
 void YTCategories::parseCategories(QByteArray bytes) {
+    JsonParseTask *task = new JsonDocumentParseTask(bytes);
+    connect(task, SIGNAL(finished()), SLOT(categoriesParsed()));
+    task->start();
+}
+
+void YTCategories::categoriesParsed() {
+    JsonDocumentParseTask *task = static_cast<JsonDocumentParseTask*>(sender());
     QList<YTCategory> categories;
 
-    QJsonDocument doc = QJsonDocument::fromJson(bytes);
-    QJsonObject obj = doc.object();
+    QJsonObject obj = task->document().object();
     QJsonArray items = obj["items"].toArray();
     foreach (const QJsonValue &v, items) {
         QJsonObject item = v.toObject();
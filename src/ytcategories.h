@@ -42,6 +42,7 @@ signals:
 
 private slots:
     void parseCategories(QByteArray bytes);
+    void categoriesParsed();
     void requestError(const QString &message);
 
 private:
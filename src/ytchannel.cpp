@@ -22,12 +22,24 @@ $END_LICENSE */
 #include "http.h"
 #include "httputils.h"
 #include "database.h"
+#include "jsonparsetask.h"
 #include <QtSql>
 
 #include "yt3.h"
 
 #include "iconutils.h"
 
+namespace {
+
+// channels waiting to be loaded with the next batched API request
+QStringList apiQueue;
+QPointer<QObject> apiQueueLoader;
+
+// channel ids requested by each in-flight API reply or parse task
+QHash<QObject*, QStringList> apiBatches;
+
+}
+
 YTChannel::YTChannel(const QString &channelId, QObject *parent) : QObject(parent),
     id(0),
     channelId(channelId),
@@ -46,10 +58,9 @@ YTChannel* YTChannel::forId(const QString &channelId) {
     if (cache.contains(channelId))
         return cache.value(channelId);
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select id,name,description,thumb_url,notify_count,watched,checked,loaded "
-                  "from subscriptions where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "select id,name,description,thumb_url,notify_count,watched,checked,loaded "
+                "from subscriptions where user_id=?");
     query.bindValue(0, channelId);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
@@ -67,6 +78,7 @@ YTChannel* YTChannel::forId(const QString &channelId) {
         channel->watched = query.value(5).toUInt();
         channel->checked = query.value(6).toUInt();
         channel->loaded = query.value(7).toUInt();
+        query.finish();
         channel->thumbnail = QPixmap(channel->getThumbnailLocation());
         channel->thumbnail.setDevicePixelRatio(IconUtils::maxSupportedPixelRatio());
         channel->maybeLoadfromAPI();
@@ -86,34 +98,67 @@ void YTChannel::maybeLoadfromAPI() {
 
     loading = true;
 
-    QUrl url = YT3::instance().method("channels");
-    QUrlQuery q(url);
-    q.addQueryItem("id", channelId);
-    q.addQueryItem("part", "snippet");
-    url.setQuery(q);
+    // Channels asking in the same event loop iteration share one request
+    if (apiQueue.isEmpty() || !apiQueueLoader) {
+        apiQueueLoader = this;
+        QTimer::singleShot(0, this, SLOT(loadFromAPI()));
+    }
+    apiQueue << channelId;
+}
 
-    QObject *reply = HttpUtils::yt().get(url);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResponse(QByteArray)));
-    connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
+void YTChannel::loadFromAPI() {
+    // the channels method takes at most 50 ids
+    static const int maxIds = 50;
+
+    while (!apiQueue.isEmpty()) {
+        const QStringList ids = apiQueue.mid(0, maxIds);
+        apiQueue = apiQueue.mid(ids.size());
+
+        QUrl url = YT3::instance().method("channels");
+        QUrlQuery q(url);
+        q.addQueryItem("id", ids.join(','));
+        q.addQueryItem("part", "snippet");
+        url.setQuery(q);
+
+        QObject *reply = HttpUtils::yt().get(url);
+        apiBatches.insert(reply, ids);
+        connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResponse(QByteArray)));
+        connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
+    }
 }
 
 void YTChannel::parseResponse(const QByteArray &bytes) {
-    QJsonDocument doc = QJsonDocument::fromJson(bytes);
-    QJsonObject obj = doc.object();
+    JsonDocumentParseTask *task = new JsonDocumentParseTask(bytes);
+    apiBatches.insert(task, apiBatches.take(sender()));
+    connect(task, SIGNAL(finished()), SLOT(responseParsed()));
+    task->start();
+}
+
+void YTChannel::responseParsed() {
+    JsonDocumentParseTask *task = static_cast<JsonDocumentParseTask*>(sender());
+    const QStringList ids = apiBatches.take(task);
+
+    QJsonObject obj = task->document().object();
     QJsonArray items = obj["items"].toArray();
     foreach (const QJsonValue &v, items) {
         QJsonObject item = v.toObject();
+        YTChannel *channel = cache.value(item["id"].toString());
+        if (!channel) continue;
         QJsonObject snippet = item["snippet"].toObject();
-        displayName = snippet["title"].toString();
-        description = snippet["description"].toString();
+        channel->displayName = snippet["title"].toString();
+        channel->description = snippet["description"].toString();
         QJsonObject thumbnails = snippet["thumbnails"].toObject();
-        thumbnailUrl = thumbnails["medium"].toObject()["url"].toString();
-        qDebug() << displayName << description << thumbnailUrl;
+        channel->thumbnailUrl = thumbnails["medium"].toObject()["url"].toString();
+        qDebug() << channel->displayName << channel->description << channel->thumbnailUrl;
     }
 
-    emit infoLoaded();
-    storeInfo();
-    loading = false;
+    foreach (const QString &id, ids) {
+        YTChannel *channel = cache.value(id);
+        if (!channel) continue;
+        emit channel->infoLoaded();
+        channel->storeInfo();
+        channel->loading = false;
+    }
 }
 
 void YTChannel::loadThumbnail() {
@@ -122,7 +167,7 @@ void YTChannel::loadThumbnail() {
     loadingThumbnail = true;
 
     QUrl url(thumbnailUrl);
-    QObject *reply = HttpUtils::yt().get(url);
+    QObject *reply = HttpUtils::yt().get(url, HttpRequest::ThumbnailPriority);
     connect(reply, SIGNAL(data(QByteArray)), SLOT(storeThumbnail(QByteArray)));
     connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
 }
@@ -137,14 +182,14 @@ QString YTChannel::getThumbnailLocation() {
 }
 
 QString YTChannel::latestVideoId() {
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select video_id from subscriptions_videos where user_id=? order by published desc limit 1");
+    QSqlQuery query = Database::instance().cachedQuery(Database::latestVideoIdSql);
     query.bindValue(0, channelId);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
     if (!query.next()) return QString();
-    return query.value(0).toString();
+    const QString videoId = query.value(0).toString();
+    query.finish();
+    return videoId;
 }
 
 void YTChannel::unsubscribe() {
@@ -177,19 +222,33 @@ void YTChannel::storeThumbnail(const QByteArray &bytes) {
 }
 
 void YTChannel::requestError(const QString &message) {
-    emit error(message);
     qWarning() << message;
-    loading = false;
-    loadingThumbnail = false;
+
+    QHash<QObject*, QStringList>::iterator i = apiBatches.find(sender());
+    if (i == apiBatches.end()) {
+        // not an API batch, so it's this channel's thumbnail
+        emit error(message);
+        loadingThumbnail = false;
+        return;
+    }
+
+    // the loader may not be part of the batch it sent
+    const QStringList ids = i.value();
+    apiBatches.erase(i);
+    foreach (const QString &id, ids) {
+        YTChannel *channel = cache.value(id);
+        if (!channel) continue;
+        channel->loading = false;
+        emit channel->error(message);
+    }
 }
 
 void YTChannel::storeInfo() {
     if (channelId.isEmpty()) return;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions set "
-                  "user_name=?, name=?, description=?, thumb_url=?, loaded=? "
-                  "where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions set "
+                "user_name=?, name=?, description=?, thumb_url=?, loaded=? "
+                "where user_id=?");
     qDebug() << userName;
     query.bindValue(0, userName);
     query.bindValue(1, displayName);
@@ -208,11 +267,10 @@ void YTChannel::subscribe(const QString &channelId) {
 
     uint now = QDateTime::currentDateTime().toTime_t();
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("insert into subscriptions "
-                  "(user_id,added,watched,checked,views,notify_count)"
-                  " values (?,?,?,0,0,0)");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "insert into subscriptions "
+                "(user_id,added,watched,checked,views,notify_count)"
+                " values (?,?,?,0,0,0)");
     query.bindValue(0, channelId);
     query.bindValue(1, now);
     query.bindValue(2, now);
@@ -225,15 +283,12 @@ void YTChannel::subscribe(const QString &channelId) {
 
 void YTChannel::unsubscribe(const QString &channelId) {
     if (channelId.isEmpty()) return;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("delete from subscriptions where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery("delete from subscriptions where user_id=?");
     query.bindValue(0, channelId);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
 
-    query = QSqlQuery(db);
-    query.prepare("delete from subscriptions_videos where user_id=?");
+    query = Database::instance().cachedQuery("delete from subscriptions_videos where user_id=?");
     query.bindValue(0, channelId);
     success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
@@ -245,15 +300,15 @@ void YTChannel::unsubscribe(const QString &channelId) {
 bool YTChannel::isSubscribed(const QString &channelId) {
     if (!Database::exists()) return false;
     if (channelId.isEmpty()) return false;
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select count(*) from subscriptions where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "select count(*) from subscriptions where user_id=?");
     query.bindValue(0, channelId);
     bool success = query.exec();
     if (!success) qWarning() << query.lastQuery() << query.lastError().text();
-    if (query.next())
-        return query.value(0).toInt() > 0;
-    return false;
+    if (!query.next()) return false;
+    const bool subscribed = query.value(0).toInt() > 0;
+    query.finish();
+    return subscribed;
 }
 
 void YTChannel::updateChecked() {
@@ -262,9 +317,8 @@ void YTChannel::updateChecked() {
     uint now = QDateTime::currentDateTime().toTime_t();
     checked = now;
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions set checked=? where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions set checked=? where user_id=?");
     query.bindValue(0, now);
     query.bindValue(1, channelId);
     bool success = query.exec();
@@ -279,9 +333,8 @@ void YTChannel::updateWatched() {
     notifyCount = 0;
     emit notifyCountChanged();
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions set watched=?, notify_count=0, views=views+1 where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions set watched=?, notify_count=0, views=views+1 where user_id=?");
     query.bindValue(0, now);
     query.bindValue(1, channelId);
     bool success = query.exec();
@@ -293,9 +346,8 @@ void YTChannel::storeNotifyCount(int count) {
         emit notifyCountChanged();
     notifyCount = count;
 
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("update subscriptions set notify_count=? where user_id=?");
+    QSqlQuery query = Database::instance().cachedQuery(
+                "update subscriptions set notify_count=? where user_id=?");
     query.bindValue(0, count);
     query.bindValue(1, channelId);
     bool success = query.exec();
@@ -303,10 +355,7 @@ void YTChannel::storeNotifyCount(int count) {
 }
 
 bool YTChannel::updateNotifyCount() {
-    QSqlDatabase db = Database::instance().getConnection();
-    QSqlQuery query(db);
-    query.prepare("select count(*) from subscriptions_videos "
-                  "where channel_id=? and added>? and published>? and watched=0");
+    QSqlQuery query = Database::instance().cachedQuery(Database::unwatchedCountSql);
     query.bindValue(0, id);
     query.bindValue(1, watched);
     query.bindValue(2, watched);
@@ -317,6 +366,7 @@ bool YTChannel::updateNotifyCount() {
         return false;
     }
     int count = query.value(0).toInt();
+    query.finish();
     storeNotifyCount(count);
     return count != notifyCount;
 }
@@ -74,7 +74,9 @@ signals:
     void notifyCountChanged();
 
 private slots:
+    void loadFromAPI();
     void parseResponse(const QByteArray &bytes);
+    void responseParsed();
     void requestError(const QString &message);
     void storeThumbnail(const QByteArray &bytes);
 
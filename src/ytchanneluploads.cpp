@@ -0,0 +1,87 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#include "ytchanneluploads.h"
+#include "http.h"
+#include "httputils.h"
+#include "video.h"
+
+#include "yt3.h"
+#include "yt3listparser.h"
+
+YTChannelUploads::YTChannelUploads(const QString &channelId, QObject *parent)
+    : PaginatedVideoSource(parent),
+      channelId(channelId),
+      publishedAfter(0) { }
+
+QString YTChannelUploads::uploadsPlaylistId(const QString &channelId) {
+    // UCxyz channels have their uploads in the UUxyz playlist
+    if (!channelId.startsWith(QLatin1String("UC"))) return QString();
+    return QLatin1String("UU") + channelId.mid(2);
+}
+
+void YTChannelUploads::loadVideos(int max, int startIndex) {
+    aborted = false;
+
+    QUrl url = YT3::instance().method("playlistItems");
+
+    QUrlQuery q(url);
+    q.addQueryItem("part", "snippet");
+    q.addQueryItem("playlistId", uploadsPlaylistId(channelId));
+    q.addQueryItem("maxResults", QString::number(max));
+
+    url.setQuery(q);
+
+    requestPage(url, max, startIndex, HttpRequest::LowPriority);
+}
+
+void YTChannelUploads::parseResults(const YT3ListParser &parser) {
+    if (aborted) return;
+
+    bool tryingWithNewToken = setPageToken(parser.getNextPageToken());
+    if (tryingWithNewToken) return;
+
+    QVector<VideoRecord> videos;
+    if (publishedAfter > 0) {
+        foreach (const VideoRecord &record, parser.getRecords())
+            if (record.published().toTime_t() > publishedAfter) videos << record;
+    } else videos = parser.getRecords();
+
+    if (name.isEmpty() && !videos.isEmpty()) {
+        name = videos.first().channelTitle();
+        emit nameChanged(name);
+    }
+
+    // playlistItems has no duration and view count
+    loadVideoDetails(videos);
+    if (asyncDetails) {
+        emit gotVideos(videos);
+        emit finished(videos.size());
+    }
+}
+
+const QStringList & YTChannelUploads::getSuggestions() {
+    static const QStringList l;
+    return l;
+}
+
+void YTChannelUploads::requestError(const QString &message) {
+    emit error(message);
+}
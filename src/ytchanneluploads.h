@@ -0,0 +1,59 @@
+/* $BEGIN_LICENSE
+
+This file is part of Minitube.
+Copyright 2009, Flavio Tordini <flavio.tordini@gmail.com>
+
+Minitube is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Minitube is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Minitube.  If not, see <http://www.gnu.org/licenses/>.
+
+$END_LICENSE */
+
+#ifndef YTCHANNELUPLOADS_H
+#define YTCHANNELUPLOADS_H
+
+#include <QtNetwork>
+#include "paginatedvideosource.h"
+
+/**
+ * The uploads playlist of a channel. Listing it costs far less API quota
+ * than a search restricted to the channel.
+ */
+class YTChannelUploads : public PaginatedVideoSource {
+
+    Q_OBJECT
+
+public:
+    YTChannelUploads(const QString &channelId, QObject *parent = 0);
+
+    // only videos published after this timestamp are returned
+    void setPublishedAfter(uint value) { publishedAfter = value; }
+
+    void loadVideos(int max, int startIndex);
+    const QStringList & getSuggestions();
+    QString getName() { return name; }
+
+    static QString uploadsPlaylistId(const QString &channelId);
+
+protected:
+    void parseResults(const YT3ListParser &parser);
+
+private slots:
+    void requestError(const QString &message);
+
+private:
+    QString channelId;
+    QString name;
+    uint publishedAfter;
+};
+
+#endif // YTCHANNELUPLOADS_H
@@ -59,11 +59,6 @@ void YTSearch::loadVideos(int max, int startIndex) {
     q.addQueryItem("type", "video");
     q.addQueryItem("maxResults", QString::number(max));
 
-    if (startIndex > 1) {
-        if (maybeReloadToken(max, startIndex)) return;
-        q.addQueryItem("pageToken", nextPageToken);
-    }
-
     // TODO interesting params
     // urlHelper.addQueryItem("videoSyndicated", "true");
     // urlHelper.addQueryItem("regionCode", "IT");
@@ -136,40 +131,34 @@ void YTSearch::loadVideos(int max, int startIndex) {
 
     url.setQuery(q);
 
-    lastUrl = url;
-
     // qWarning() << "YT3 search" << url.toString();
-    QObject *reply = HttpUtils::yt().get(url);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResults(QByteArray)));
-    connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
+    // transient searches are background work, e.g. subscription checks
+    HttpRequest::Priority priority = searchParams->isTransient() ?
+                HttpRequest::LowPriority : HttpRequest::HighPriority;
+    requestPage(url, max, startIndex, priority);
 }
 
-void YTSearch::parseResults(QByteArray data) {
+void YTSearch::parseResults(const YT3ListParser &parser) {
     if (aborted) return;
-
-    YT3ListParser parser(data);
-    QList<Video*> videos = parser.getVideos();
     suggestions = parser.getSuggestions();
 
     bool tryingWithNewToken = setPageToken(parser.getNextPageToken());
     if (tryingWithNewToken) return;
 
+    QVector<VideoRecord> videos = parser.getRecords();
+
     if (name.isEmpty() && !searchParams->channelId().isEmpty()) {
         if (!videos.isEmpty()) {
-            name = videos.first()->channelTitle();
+            name = videos.first().channelTitle();
         }
         emit nameChanged(name);
     }
 
+    loadVideoDetails(videos);
     if (asyncDetails) {
         emit gotVideos(videos);
         emit finished(videos.size());
     }
-    loadVideoDetails(videos);
-}
-
-void YTSearch::abort() {
-    aborted = true;
 }
 
 const QStringList & YTSearch::getSuggestions() {
@@ -34,7 +34,6 @@ class YTSearch : public PaginatedVideoSource {
 public:
     YTSearch(SearchParams *params, QObject *parent = 0);
     void loadVideos(int max, int startIndex);
-    void abort();
     const QStringList & getSuggestions();
     QString getName();
     QList<QAction*> getActions();
@@ -45,13 +44,14 @@ public:
         return searchParams == other.getSearchParams();
     }
 
+protected:
+    void parseResults(const YT3ListParser &parser);
+
 private slots:
-    void parseResults(QByteArray data);
     void requestError(const QString &message);
 
 private:
     SearchParams *searchParams;
-    bool aborted;
     QStringList suggestions;
     QString name;
 };
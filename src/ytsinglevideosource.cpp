@@ -27,9 +27,11 @@ $END_LICENSE */
 #include "yt3listparser.h"
 
 YTSingleVideoSource::YTSingleVideoSource(QObject *parent) : PaginatedVideoSource(parent),
-    video(0),
     startIndex(0),
-    max(0) { }
+    max(0) {
+    // the video itself comes first, related videos start at 2
+    firstPageIndex = 2;
+}
 
 void YTSingleVideoSource::loadVideos(int max, int startIndex) {
     aborted = false;
@@ -40,11 +42,11 @@ void YTSingleVideoSource::loadVideos(int max, int startIndex) {
 
     if (startIndex == 1) {
 
-        if (video) {
-            QList<Video*> videos;
-            videos << video->clone();
+        if (!video.id().isEmpty()) {
+            QVector<VideoRecord> videos;
+            videos << video;
             if (name.isEmpty()) {
-                name = videos.first()->title();
+                name = video.title();
                 qDebug() << "Emitting name changed" << name;
                 emit nameChanged(name);
             }
@@ -66,39 +68,26 @@ void YTSingleVideoSource::loadVideos(int max, int startIndex) {
         q.addQueryItem("type", "video");
         q.addQueryItem("relatedToVideoId", videoId);
         q.addQueryItem("maxResults", QString::number(max));
-        if (startIndex > 2) {
-            if (maybeReloadToken(max, startIndex)) return;
-            q.addQueryItem("pageToken", nextPageToken);
-        }
         url.setQuery(q);
     }
 
-    lastUrl = url;
-
-    QObject *reply = HttpUtils::yt().get(url);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResults(QByteArray)));
-    connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
+    requestPage(url, max, startIndex);
 }
 
-void YTSingleVideoSource::parseResults(QByteArray data) {
+void YTSingleVideoSource::parseResults(const YT3ListParser &parser) {
     if (aborted) return;
 
-    YT3ListParser parser(data);
-    QList<Video*> videos = parser.getVideos();
-
     bool tryingWithNewToken = setPageToken(parser.getNextPageToken());
     if (tryingWithNewToken) return;
 
+    QVector<VideoRecord> videos = parser.getRecords();
+
+    loadVideoDetails(videos);
     if (asyncDetails) {
         emit gotVideos(videos);
         if (startIndex == 2) emit finished(videos.size() + 1);
         else emit finished(videos.size());
     }
-    loadVideoDetails(videos);
-}
-
-void YTSingleVideoSource::abort() {
-    aborted = true;
 }
 
 const QStringList & YTSingleVideoSource::getSuggestions() {
@@ -111,7 +100,7 @@ QString YTSingleVideoSource::getName() {
 }
 
 void YTSingleVideoSource::setVideo(Video *video) {
-    this->video = video;
+    this->video = video->record();
     videoId = video->id();
 }
 
@@ -24,6 +24,8 @@ $END_LICENSE */
 #include <QtNetwork>
 #include "paginatedvideosource.h"
 
+class Video;
+
 class YTSingleVideoSource : public PaginatedVideoSource {
 
     Q_OBJECT
@@ -31,21 +33,21 @@ class YTSingleVideoSource : public PaginatedVideoSource {
 public:
     YTSingleVideoSource(QObject *parent = 0);
     void loadVideos(int max, int startIndex);
-    void abort();
     const QStringList & getSuggestions();
     QString getName();
 
     void setVideoId(const QString &value) { videoId = value; }
     void setVideo(Video *video);
 
+protected:
+    void parseResults(const YT3ListParser &parser);
+
 private slots:
-    void parseResults(QByteArray data);
     void requestError(const QString &message);
 
 private:
-    Video *video;
+    VideoRecord video;
     QString videoId;
-    bool aborted;
     int startIndex;
     int max;
     QString name;
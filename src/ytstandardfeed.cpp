@@ -27,8 +27,7 @@ $END_LICENSE */
 #include "yt3listparser.h"
 
 YTStandardFeed::YTStandardFeed(QObject *parent)
-    : PaginatedVideoSource(parent),
-      aborted(false) { }
+    : PaginatedVideoSource(parent) { }
 
 void YTStandardFeed::loadVideos(int max, int startIndex) {
     aborted = false;
@@ -36,11 +35,6 @@ void YTStandardFeed::loadVideos(int max, int startIndex) {
     QUrl url = YT3::instance().method("videos");
 
     QUrlQuery q(url);
-    if (startIndex > 1) {
-        if (maybeReloadToken(max, startIndex)) return;
-        q.addQueryItem("pageToken", nextPageToken);
-    }
-
     q.addQueryItem("part", "snippet,contentDetails,statistics");
     q.addQueryItem("chart", "mostPopular");
 
@@ -54,17 +48,12 @@ void YTStandardFeed::loadVideos(int max, int startIndex) {
 
     url.setQuery(q);
 
-    QObject *reply = HttpUtils::yt().get(url);
-    connect(reply, SIGNAL(data(QByteArray)), SLOT(parseResults(QByteArray)));
-    connect(reply, SIGNAL(error(QString)), SLOT(requestError(QString)));
+    requestPage(url, max, startIndex);
 }
 
-void YTStandardFeed::parseResults(QByteArray data) {
+void YTStandardFeed::parseResults(const YT3ListParser &parser) {
     if (aborted) return;
 
-    YT3ListParser parser(data);
-    QList<Video*> videos = parser.getVideos();
-
     bool tryingWithNewToken = setPageToken(parser.getNextPageToken());
     if (tryingWithNewToken) return;
 
@@ -75,14 +64,11 @@ void YTStandardFeed::parseResults(QByteArray data) {
         return;
     }
 
+    const QVector<VideoRecord> &videos = parser.getRecords();
     emit gotVideos(videos);
     emit finished(videos.size());
 }
 
-void YTStandardFeed::abort() {
-    aborted = true;
-}
-
 const QStringList & YTStandardFeed::getSuggestions() {
     static const QStringList l;
     return l;
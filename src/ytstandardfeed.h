@@ -47,12 +47,13 @@ public:
     void setTime(const QString &value) { time = value; }
 
     void loadVideos(int max, int startIndex);
-    void abort();
     const QStringList & getSuggestions();
     QString getName() { return label; }
 
+protected:
+    void parseResults(const YT3ListParser &parser);
+
 private slots:
-    void parseResults(QByteArray data);
     void requestError(const QString &message);
 
 private:
@@ -61,7 +62,6 @@ private:
     QString category;
     QString label;
     QString time;
-    bool aborted;
 };
 
 #endif // YTSTANDARDFEED_H
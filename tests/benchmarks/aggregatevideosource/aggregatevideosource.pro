@@ -0,0 +1,17 @@
+TARGET = tst_aggregatevideosource
+# video.h and videosource.h include widgets and network headers
+QT += widgets network
+
+include(../benchmark.pri)
+include(../database.pri)
+
+HEADERS += \
+    $$SRC_DIR/aggregatevideosource.h \
+    $$SRC_DIR/videosource.h \
+    $$SRC_DIR/videorecord.h
+
+SOURCES += \
+    $$SRC_DIR/aggregatevideosource.cpp \
+    $$SRC_DIR/videosource.cpp \
+    $$SRC_DIR/videorecord.cpp \
+    tst_aggregatevideosource.cpp
@@ -0,0 +1,263 @@
+#include <QtTest>
+
+#include "aggregatevideosource.h"
+#include "database.h"
+
+/*
+ * Paging through 100k stored videos with AggregateVideoSource, 50 at a time,
+ * like pressing "Show more" over and over.
+ *
+ * keyset keeps one source for all pages, so every page after the first
+ * seeks past the last row of the previous one.
+ * offset uses a new source for each page, which makes it fall back to
+ * "limit ?,?" and skip all earlier rows, as every page did before.
+ *
+ * decode and allocations load a single page. "legacy" is the query
+ * loadVideos() used to run: prepared again for every page, scrollable,
+ * so QSQLITE caches each row, and also selecting the stored url.
+ * The Video QObject the old code created per row is not part of it.
+ */
+
+namespace {
+
+const int channelCount = 100;
+const int videoCount = 100000;
+const int pageSize = 50;
+
+// malloc() calls while counting is on, nothing else runs meanwhile
+bool countAllocations = false;
+int allocationCount = 0;
+
+}
+
+#ifdef __GLIBC__
+// Counting heap profiler, operator new and Qt containers both end up here
+// __THROW matches the exception specification of the glibc declarations
+extern "C" void *__libc_malloc(size_t size) __THROW;
+
+extern "C" void *malloc(size_t size) __THROW {
+    if (countAllocations) allocationCount++;
+    return __libc_malloc(size);
+}
+#endif
+
+class AggregateVideoSourceBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void keyset_data();
+    void keyset();
+    void offset_data();
+    void offset();
+    void decode_data();
+    void decode();
+    void allocations_data();
+    void allocations();
+
+private:
+    void addRows();
+    void addDecodeRows();
+    int loadPage(bool legacy);
+};
+
+void AggregateVideoSourceBenchmark::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
+    Database::instance().drop();
+
+    QSqlDatabase db = Database::instance().getConnection();
+    QVERIFY(db.transaction());
+
+    QSqlQuery channelQuery(db);
+    channelQuery.prepare("insert into subscriptions "
+                         "(id,user_id,name,added,checked,updated,watched,loaded,notify_count,views) "
+                         "values (?,?,?,0,0,0,0,0,0,0)");
+    for (int i = 1; i <= channelCount; ++i) {
+        channelQuery.bindValue(0, i);
+        channelQuery.bindValue(1, QString("UCbenchmark" + QString::number(i)));
+        channelQuery.bindValue(2, QString("Channel " + QString::number(i)));
+        QVERIFY2(channelQuery.exec(), qPrintable(channelQuery.lastError().text()));
+    }
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    QVariantList ids, channelIds, published, added, titles, authors, userIds,
+            descriptions, thumbUrls, views, durations;
+    for (int i = 0; i < videoCount; ++i) {
+        const int channel = i % channelCount + 1;
+        const QString id = "vid" + QString::number(i);
+        ids << id;
+        channelIds << channel;
+        // a few videos share a publish time, the cursor has to break ties by id
+        published << now - i / 4 * 60;
+        added << now;
+        titles << QString("Video " + id);
+        authors << QString("Channel " + QString::number(channel));
+        userIds << QString("UCbenchmark" + QString::number(channel));
+        descriptions << QString(200, 'd');
+        thumbUrls << QString("https://i.ytimg.com/vi/" + id + "/default.jpg");
+        views << 1000;
+        durations << 600;
+    }
+    QSqlQuery videoQuery(db);
+    videoQuery.prepare("insert into subscriptions_videos "
+                       "(video_id,channel_id,published,added,watched,"
+                       "title,author,user_id,description,thumb_url,views,duration) "
+                       "values (?,?,?,?,0,?,?,?,?,?,?,?)");
+    videoQuery.addBindValue(ids);
+    videoQuery.addBindValue(channelIds);
+    videoQuery.addBindValue(published);
+    videoQuery.addBindValue(added);
+    videoQuery.addBindValue(titles);
+    videoQuery.addBindValue(authors);
+    videoQuery.addBindValue(userIds);
+    videoQuery.addBindValue(descriptions);
+    videoQuery.addBindValue(thumbUrls);
+    videoQuery.addBindValue(views);
+    videoQuery.addBindValue(durations);
+    QVERIFY2(videoQuery.execBatch(), qPrintable(videoQuery.lastError().text()));
+
+    QVERIFY(db.commit());
+    QSqlQuery analyzeQuery(db);
+    QVERIFY(analyzeQuery.exec("analyze"));
+}
+
+void AggregateVideoSourceBenchmark::cleanupTestCase() {
+    Database::instance().drop();
+}
+
+void AggregateVideoSourceBenchmark::addRows() {
+    QTest::addColumn<int>("pages");
+    QTest::addColumn<bool>("unwatched");
+    QTest::newRow("10 pages") << 10 << false;
+    QTest::newRow("100 pages") << 100 << false;
+    QTest::newRow("1000 pages") << 1000 << false;
+    QTest::newRow("10 pages, unwatched") << 10 << true;
+    QTest::newRow("100 pages, unwatched") << 100 << true;
+    QTest::newRow("1000 pages, unwatched") << 1000 << true;
+}
+
+void AggregateVideoSourceBenchmark::keyset_data() {
+    addRows();
+}
+
+void AggregateVideoSourceBenchmark::keyset() {
+    QFETCH(int, pages);
+    QFETCH(bool, unwatched);
+
+    QBENCHMARK {
+        AggregateVideoSource source;
+        source.setUnwatched(unwatched);
+        QSignalSpy spy(&source, SIGNAL(finished(int)));
+        for (int page = 0; page < pages; ++page)
+            source.loadVideos(pageSize, page * pageSize + 1);
+        QCOMPARE(spy.count(), pages);
+        QCOMPARE(spy.last().first().toInt(), pageSize);
+    }
+}
+
+void AggregateVideoSourceBenchmark::offset_data() {
+    addRows();
+}
+
+void AggregateVideoSourceBenchmark::offset() {
+    QFETCH(int, pages);
+    QFETCH(bool, unwatched);
+
+    QBENCHMARK {
+        for (int page = 0; page < pages; ++page) {
+            AggregateVideoSource source;
+            source.setUnwatched(unwatched);
+            QSignalSpy spy(&source, SIGNAL(finished(int)));
+            source.loadVideos(pageSize, page * pageSize + 1);
+            QCOMPARE(spy.count(), 1);
+            QCOMPARE(spy.first().first().toInt(), pageSize);
+        }
+    }
+}
+
+void AggregateVideoSourceBenchmark::addDecodeRows() {
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("source") << false;
+    QTest::newRow("legacy") << true;
+}
+
+int AggregateVideoSourceBenchmark::loadPage(bool legacy) {
+    if (!legacy) {
+        AggregateVideoSource source;
+        QSignalSpy spy(&source, SIGNAL(finished(int)));
+        source.loadVideos(pageSize, 1);
+        return spy.isEmpty() ? 0 : spy.first().first().toInt();
+    }
+
+    QSqlQuery query(Database::instance().getConnection());
+    query.prepare("select v.video_id,"
+                  "v.published,"
+                  "v.title,"
+                  "v.author,"
+                  "v.user_id,"
+                  "v.description,"
+                  "v.url,"
+                  "v.thumb_url,"
+                  "v.views,"
+                  "v.duration,"
+                  "v.id"
+                  " from subscriptions_videos v where 1 "
+                  "order by v.published desc, v.id desc limit ?,?");
+    query.bindValue(0, 0);
+    query.bindValue(1, pageSize);
+    bool success = query.exec();
+    if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+    QVector<VideoRecord> videos;
+    while (query.next()) {
+        VideoRecord video;
+        video.setId(query.value(0).toString());
+        video.setPublished(QDateTime::fromTime_t(query.value(1).toUInt()));
+        video.setTitle(query.value(2).toString());
+        video.setChannelTitle(query.value(3).toString());
+        video.setChannelId(query.value(4).toString());
+        video.setDescription(query.value(5).toString());
+        video.setWebpage(query.value(6).toString());
+        video.setThumbnailUrl(query.value(7).toString());
+        video.setViewCount(query.value(8).toInt());
+        video.setDuration(query.value(9).toInt());
+        videos << video;
+    }
+    return videos.size();
+}
+
+void AggregateVideoSourceBenchmark::decode_data() {
+    addDecodeRows();
+}
+
+void AggregateVideoSourceBenchmark::decode() {
+    QFETCH(bool, legacy);
+    QBENCHMARK {
+        QCOMPARE(loadPage(legacy), pageSize);
+    }
+}
+
+void AggregateVideoSourceBenchmark::allocations_data() {
+    addDecodeRows();
+}
+
+void AggregateVideoSourceBenchmark::allocations() {
+#ifndef __GLIBC__
+    QSKIP("Counting allocations needs glibc");
+#endif
+    QFETCH(bool, legacy);
+    // warm up statement caches and lazily created Qt internals
+    QCOMPARE(loadPage(legacy), pageSize);
+
+    const int pages = 100;
+    allocationCount = 0;
+    countAllocations = true;
+    for (int i = 0; i < pages; ++i) loadPage(legacy);
+    countAllocations = false;
+    QTest::setBenchmarkResult(qreal(allocationCount) / pages, QTest::Events);
+}
+
+QTEST_GUILESS_MAIN(AggregateVideoSourceBenchmark)
+
+#include "tst_aggregatevideosource.moc"
@@ -0,0 +1,12 @@
+CONFIG += testcase c++11 release
+CONFIG -= app_bundle
+QT += testlib
+
+# same as the application, the code under test relies on them
+DEFINES *= QT_NO_DEBUG_OUTPUT
+DEFINES *= QT_USE_QSTRINGBUILDER
+DEFINES *= QT_STRICT_ITERATORS
+
+SRC_DIR = $$PWD/../../src
+INCLUDEPATH += $$SRC_DIR
+DEPENDPATH += $$SRC_DIR
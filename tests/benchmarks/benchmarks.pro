@@ -0,0 +1,11 @@
+# Micro-benchmarks, build and run them with:
+# qmake tests/benchmarks/benchmarks.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    aggregatevideosource \
+    cachedhttp \
+    channelaggregator \
+    fmturlmap \
+    playerdecipher \
+    yt3listparser
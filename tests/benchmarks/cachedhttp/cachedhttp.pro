@@ -0,0 +1,7 @@
+TARGET = tst_cachedhttp
+QT -= gui
+
+include(../benchmark.pri)
+include($$SRC_DIR/http/http.pri)
+
+SOURCES += tst_cachedhttp.cpp
@@ -0,0 +1,216 @@
+#include <QtTest>
+
+#include "cachedhttp.h"
+#include "localcache.h"
+
+/*
+ * GUI-thread time of 100 cached requests, the thumbnails and JSON pages
+ * of a 50 item playlist. Only the time the issuing thread is busy counts:
+ * issuing the requests and dispatching the events that deliver them.
+ * Waiting for the I/O thread does not.
+ *
+ * syncHits reproduces the old CachedHttpReply::emitSignals() path,
+ * LocalCache::isCached() and value() called on the issuing thread.
+ */
+
+namespace {
+
+const int playlistSize = 50;
+const int rounds = 20;
+
+class FakeReply : public HttpReply {
+
+    Q_OBJECT
+
+public:
+    FakeReply(const HttpRequest &req, const QByteArray &bytes) : req(req), bytes(bytes) {
+        QMetaObject::invokeMethod(this, "emitFinished", Qt::QueuedConnection);
+    }
+    QUrl url() const { return req.url; }
+    int statusCode() const { return 200; }
+    QByteArray body() const { return bytes; }
+
+private slots:
+    void emitFinished() {
+        emit data(bytes);
+        emit finished(*this);
+        deleteLater();
+    }
+
+private:
+    HttpRequest req;
+    QByteArray bytes;
+};
+
+// Origin answering from memory on the next event loop iteration
+class FakeHttp : public Http {
+
+public:
+    QObject *request(const HttpRequest &req) {
+        const bool thumbnail = req.url.path().endsWith(QLatin1String(".jpg"));
+        return new FakeReply(req, thumbnail ? thumbnailBytes : pageBytes);
+    }
+
+    QByteArray thumbnailBytes;
+    QByteArray pageBytes;
+};
+
+QStringList playlistUrls(const QString &tag) {
+    QStringList urls;
+    for (int i = 0; i < playlistSize; ++i) {
+        const QString n = QString::number(i);
+        urls << QString("https://i.ytimg.com/vi/" + tag + n + "/mqdefault.jpg")
+             << QString("https://www.googleapis.com/youtube/v3/videos?id=" + tag + n);
+    }
+    return urls;
+}
+
+}
+
+class CachedHttpBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void syncHits_data();
+    void syncHits();
+    void hits_data();
+    void hits();
+    void misses_data();
+    void misses();
+
+    void replyFinished();
+
+private:
+    qint64 runRound(Http &http, const QStringList &urls);
+    void addBackendRows();
+
+    FakeHttp origin;
+    int finishedCount;
+};
+
+void CachedHttpBenchmark::initTestCase() {
+    // keeps the cache out of the user's cache directory
+    QStandardPaths::setTestModeEnabled(true);
+    origin.thumbnailBytes = QByteArray(12 * 1024, 't');
+    origin.pageBytes = QByteArray(60 * 1024, 'p');
+}
+
+void CachedHttpBenchmark::cleanupTestCase() {
+    CachedHttp::ioThreadPool()->waitForDone();
+    LocalCache::instance("bench-files")->clear();
+    LocalCache::instance("bench-indexed", LocalCache::IndexedBackend)->clear();
+}
+
+void CachedHttpBenchmark::addBackendRows() {
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<int>("backend");
+    QTest::newRow("files") << QString("bench-files") << int(LocalCache::FilesBackend);
+    QTest::newRow("indexed") << QString("bench-indexed") << int(LocalCache::IndexedBackend);
+}
+
+void CachedHttpBenchmark::replyFinished() {
+    finishedCount++;
+}
+
+qint64 CachedHttpBenchmark::runRound(Http &http, const QStringList &urls) {
+    QElapsedTimer timer;
+    qint64 busy = 0;
+    finishedCount = 0;
+
+    timer.start();
+    foreach (const QString &url, urls) {
+        QObject *reply = http.get(QUrl(url));
+        connect(reply, SIGNAL(finished(HttpReply)), SLOT(replyFinished()));
+    }
+    busy += timer.nsecsElapsed();
+
+    QElapsedTimer deadline;
+    deadline.start();
+    while (finishedCount < urls.size()) {
+        if (deadline.elapsed() > 10000) return -1;
+        timer.start();
+        QCoreApplication::processEvents();
+        busy += timer.nsecsElapsed();
+        QThread::usleep(200);
+    }
+    return busy;
+}
+
+void CachedHttpBenchmark::syncHits_data() {
+    addBackendRows();
+}
+
+void CachedHttpBenchmark::syncHits() {
+    QFETCH(QString, name);
+    QFETCH(int, backend);
+    LocalCache *cache = LocalCache::instance(name, LocalCache::Backend(backend));
+
+    QStringList keys;
+    foreach (const QString &url, playlistUrls("sync")) {
+        const QString key = LocalCache::hash(url);
+        cache->insert(key, url.endsWith(QLatin1String(".jpg")) ? origin.thumbnailBytes
+                                                                : origin.pageBytes);
+        keys << key;
+    }
+
+    QElapsedTimer timer;
+    qint64 busy = 0;
+    for (int i = 0; i < rounds; ++i) {
+        timer.start();
+        foreach (const QString &key, keys) {
+            if (cache->isCached(key)) QVERIFY(!cache->value(key).isEmpty());
+        }
+        busy += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(busy / rounds / 1000000., QTest::WalltimeMilliseconds);
+}
+
+void CachedHttpBenchmark::hits_data() {
+    addBackendRows();
+}
+
+void CachedHttpBenchmark::hits() {
+    QFETCH(QString, name);
+    QFETCH(int, backend);
+    CachedHttp http(origin, name, LocalCache::Backend(backend));
+
+    // the first round misses and fills the cache
+    const QStringList urls = playlistUrls("hits");
+    QVERIFY(runRound(http, urls) >= 0);
+    CachedHttp::ioThreadPool()->waitForDone();
+
+    qint64 busy = 0;
+    for (int i = 0; i < rounds; ++i) {
+        const qint64 roundBusy = runRound(http, urls);
+        QVERIFY(roundBusy >= 0);
+        busy += roundBusy;
+    }
+    QTest::setBenchmarkResult(busy / rounds / 1000000., QTest::WalltimeMilliseconds);
+}
+
+void CachedHttpBenchmark::misses_data() {
+    addBackendRows();
+}
+
+void CachedHttpBenchmark::misses() {
+    QFETCH(QString, name);
+    QFETCH(int, backend);
+    CachedHttp http(origin, name, LocalCache::Backend(backend));
+
+    // new urls every round, each one is looked up, fetched and inserted
+    qint64 busy = 0;
+    for (int i = 0; i < rounds; ++i) {
+        const qint64 roundBusy = runRound(http, playlistUrls("miss" + QString::number(i) + '-'));
+        QVERIFY(roundBusy >= 0);
+        busy += roundBusy;
+    }
+    CachedHttp::ioThreadPool()->waitForDone();
+    QTest::setBenchmarkResult(busy / rounds / 1000000., QTest::WalltimeMilliseconds);
+}
+
+QTEST_GUILESS_MAIN(CachedHttpBenchmark)
+
+#include "tst_cachedhttp.moc"
@@ -0,0 +1,14 @@
+TARGET = tst_channelaggregator
+QT -= gui
+
+include(../benchmark.pri)
+include(../database.pri)
+
+HEADERS += \
+    $$SRC_DIR/subscriptionvideos.h \
+    $$SRC_DIR/videorecord.h
+
+SOURCES += \
+    $$SRC_DIR/subscriptionvideos.cpp \
+    $$SRC_DIR/videorecord.cpp \
+    tst_channelaggregator.cpp
@@ -0,0 +1,204 @@
+#include <QtTest>
+
+#include "database.h"
+#include "videorecord.h"
+#include "subscriptionvideos.h"
+
+/*
+ * Storing 10k videos from 100 channels, the way ChannelAggregator does.
+ * ChannelAggregator itself needs YTChannel and the network, so the test
+ * groups videos by subscription row id itself:
+ *
+ * perRow is the old addVideo(), a count, an insert and an update for each
+ * video with freshly prepared statements, copied here.
+ * batch is SubscriptionVideos::add(), what addVideos() calls per channel:
+ * one INSERT OR IGNORE execBatch() and one update if anything was new.
+ *
+ * The "known" rows store videos that are already in the database,
+ * the usual case when refreshing subscriptions.
+ */
+
+namespace {
+
+const int channelCount = 100;
+const int videosPerChannel = 100;
+
+}
+
+class ChannelAggregatorBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void perRow_data();
+    void perRow();
+    void batch_data();
+    void batch();
+
+private:
+    void addRows();
+    void perRowInsert(const QVector<VideoRecord> &videos);
+    void batchInsert(const QVector<VideoRecord> &videos);
+
+    QHash<QString, int> channelIds;
+    QVector<VideoRecord> videos;
+    int newVideoCount;
+};
+
+void ChannelAggregatorBenchmark::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
+    Database::instance().drop();
+
+    QSqlDatabase db = Database::instance().getConnection();
+    QVERIFY(db.transaction());
+    for (int i = 0; i < channelCount; ++i) {
+        const QString channelId = "UCbenchmark" + QString::number(i);
+        QSqlQuery query(db);
+        query.prepare("insert into subscriptions "
+                      "(user_id,name,added,checked,updated,watched,loaded,notify_count,views) "
+                      "values (?,?,0,0,0,0,0,0,0)");
+        query.bindValue(0, channelId);
+        query.bindValue(1, QString("Channel " + QString::number(i)));
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        channelIds.insert(channelId, query.lastInsertId().toInt());
+    }
+    QVERIFY(db.commit());
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    videos.reserve(channelCount * videosPerChannel);
+    // interleaved like the results of a parallel check
+    for (int v = 0; v < videosPerChannel; ++v) {
+        for (int c = 0; c < channelCount; ++c) {
+            const QString id = "vid" + QString::number(c) + '_' + QString::number(v);
+            VideoRecord video;
+            video.setId(id);
+            video.setTitle(QString("Video " + id));
+            video.setDescription(QString(200, 'd'));
+            video.setChannelId("UCbenchmark" + QString::number(c));
+            video.setChannelTitle(QString("Channel " + QString::number(c)));
+            video.setThumbnailUrl(QString("https://i.ytimg.com/vi/" + id + "/default.jpg"));
+            video.setDuration(600);
+            video.setViewCount(1000);
+            video.setPublished(now.addSecs(-60 * (v * channelCount + c)));
+            videos << video;
+        }
+    }
+}
+
+void ChannelAggregatorBenchmark::cleanupTestCase() {
+    Database::instance().drop();
+}
+
+void ChannelAggregatorBenchmark::init() {
+    newVideoCount = 0;
+    QSqlQuery query(Database::instance().getConnection());
+    QVERIFY(query.exec("delete from subscriptions_videos"));
+}
+
+void ChannelAggregatorBenchmark::addRows() {
+    QTest::addColumn<bool>("known");
+    QTest::newRow("new") << false;
+    QTest::newRow("known") << true;
+}
+
+void ChannelAggregatorBenchmark::perRowInsert(const QVector<VideoRecord> &videos) {
+    QSqlDatabase db = Database::instance().getConnection();
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    foreach (const VideoRecord &video, videos) {
+        QSqlQuery query(db);
+        query.prepare("select count(*) from subscriptions_videos where video_id=?");
+        query.bindValue(0, video.id());
+        bool success = query.exec();
+        if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+        if (!query.next()) continue;
+        if (query.value(0).toInt() > 0) continue;
+
+        const int channelId = channelIds.value(video.channelId());
+        uint published = video.published().toTime_t();
+        if (published > now) published = now;
+
+        query = QSqlQuery(db);
+        query.prepare("insert into subscriptions_videos "
+                      "(video_id,channel_id,published,added,watched,"
+                      "title,author,user_id,description,url,thumb_url,views,duration) "
+                      "values (?,?,?,?,?,?,?,?,?,?,?,?,?)");
+        query.bindValue(0, video.id());
+        query.bindValue(1, channelId);
+        query.bindValue(2, published);
+        query.bindValue(3, now);
+        query.bindValue(4, 0);
+        query.bindValue(5, video.title());
+        query.bindValue(6, video.channelTitle());
+        query.bindValue(7, video.channelId());
+        query.bindValue(8, video.description());
+        query.bindValue(9, QString("https://www.youtube.com/watch?v=" + video.id()));
+        query.bindValue(10, video.thumbnailUrl());
+        query.bindValue(11, video.viewCount());
+        query.bindValue(12, video.duration());
+        success = query.exec();
+        if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+
+        newVideoCount++;
+
+        query = QSqlQuery(db);
+        query.prepare("update subscriptions set updated=? where user_id=?");
+        query.bindValue(0, published);
+        query.bindValue(1, video.channelId());
+        success = query.exec();
+        if (!success) qWarning() << query.lastQuery() << query.lastError().text();
+
+        QCoreApplication::processEvents();
+    }
+}
+
+void ChannelAggregatorBenchmark::batchInsert(const QVector<VideoRecord> &videos) {
+    QList<int> channels;
+    QHash<int, QVector<VideoRecord> > channelVideos;
+    foreach (const VideoRecord &video, videos) {
+        const int channelId = channelIds.value(video.channelId());
+        if (!channelVideos.contains(channelId)) channels << channelId;
+        channelVideos[channelId] << video;
+    }
+
+    foreach (int channelId, channels)
+        newVideoCount += SubscriptionVideos::add(channelId, channelVideos[channelId]);
+}
+
+void ChannelAggregatorBenchmark::perRow_data() {
+    addRows();
+}
+
+void ChannelAggregatorBenchmark::perRow() {
+    QFETCH(bool, known);
+    if (known) batchInsert(videos);
+
+    // a second iteration would only see known videos
+    newVideoCount = 0;
+    QBENCHMARK_ONCE {
+        perRowInsert(videos);
+    }
+    QCOMPARE(newVideoCount, known ? 0 : videos.size());
+}
+
+void ChannelAggregatorBenchmark::batch_data() {
+    addRows();
+}
+
+void ChannelAggregatorBenchmark::batch() {
+    QFETCH(bool, known);
+    if (known) batchInsert(videos);
+
+    newVideoCount = 0;
+    QBENCHMARK_ONCE {
+        batchInsert(videos);
+    }
+    QCOMPARE(newVideoCount, known ? 0 : videos.size());
+}
+
+QTEST_GUILESS_MAIN(ChannelAggregatorBenchmark)
+
+#include "tst_channelaggregator.moc"
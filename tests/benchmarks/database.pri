@@ -0,0 +1,14 @@
+# Database with its migrations, kept under QStandardPaths test mode
+QT *= sql
+
+DEFINES += APP_NAME=MinitubeBenchmarks
+DEFINES += APP_UNIX_NAME=minitube-benchmarks
+DEFINES += APP_VERSION=0
+
+HEADERS += \
+    $$SRC_DIR/database.h \
+    $$SRC_DIR/constants.h
+
+SOURCES += \
+    $$SRC_DIR/database.cpp \
+    $$SRC_DIR/constants.cpp
@@ -0,0 +1,8 @@
+TARGET = tst_fmturlmap
+QT -= gui
+
+include(../benchmark.pri)
+
+HEADERS += $$SRC_DIR/fmturlmap.h
+SOURCES += $$SRC_DIR/fmturlmap.cpp \
+    tst_fmturlmap.cpp
@@ -0,0 +1,138 @@
+#include <QtTest>
+
+#include "fmturlmap.h"
+
+/*
+ * Parsing the format maps of a get_video_info payload.
+ *
+ * singlePass is FmtUrlMap::parse(), what Video::parseFmtUrlMap() uses.
+ * split is the QString::split() version it replaced, copied here.
+ *
+ * The maps are taken out of the payload and percent-decoded once,
+ * like Video::gotVideoInfo() does, before the timing starts.
+ * The payloads in data/ follow the layout of get_video_info responses,
+ * one with plain signatures and one with encrypted ones.
+ */
+
+namespace {
+
+QVector<FmtUrlMap::Format> splitParse(const QString &fmtUrlMap) {
+    QVector<FmtUrlMap::Format> formats;
+    const QStringList formatUrls = fmtUrlMap.split(',', QString::SkipEmptyParts);
+    foreach (const QString &formatUrl, formatUrls) {
+        FmtUrlMap::Format format;
+        const QStringList urlParams = formatUrl.split('&', QString::SkipEmptyParts);
+        foreach (const QString &urlParam, urlParams) {
+            if (urlParam.startsWith("itag=")) {
+                int separator = urlParam.indexOf("=");
+                format.itag = urlParam.mid(separator + 1).toInt();
+            } else if (urlParam.startsWith("url=")) {
+                int separator = urlParam.indexOf("=");
+                format.url = urlParam.mid(separator + 1);
+                format.url = QByteArray::fromPercentEncoding(format.url.toUtf8());
+            } else if (urlParam.startsWith("sig=")) {
+                int separator = urlParam.indexOf("=");
+                format.sig = urlParam.mid(separator + 1);
+                format.sig = QByteArray::fromPercentEncoding(format.sig.toUtf8());
+                format.encrypted = false;
+            } else if (urlParam.startsWith("s=")) {
+                int separator = urlParam.indexOf("=");
+                format.sig = urlParam.mid(separator + 1);
+                format.sig = QByteArray::fromPercentEncoding(format.sig.toUtf8());
+                format.encrypted = true;
+            }
+        }
+        formats << format;
+    }
+    return formats;
+}
+
+}
+
+class FmtUrlMapBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void sameFormats_data();
+    void sameFormats();
+    void singlePass_data();
+    void singlePass();
+    void split_data();
+    void split();
+
+private:
+    void addPayloadRows();
+};
+
+void FmtUrlMapBenchmark::addPayloadRows() {
+    QTest::addColumn<QString>("fmtUrlMap");
+    QTest::addColumn<int>("formatCount");
+
+    const char *payloads[] = { "get_video_info", "get_video_info_encrypted" };
+    const char *maps[] = { "url_encoded_fmt_stream_map", "adaptive_fmts" };
+    const int formatCounts[] = { 5, 25 };
+    for (int i = 0; i < 2; ++i) {
+        const QString fileName = QString("data/") + payloads[i] + ".txt";
+        QFile file(QFINDTESTDATA(fileName));
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.fileName()));
+        const QString videoInfo = QString::fromUtf8(file.readAll());
+        for (int j = 0; j < 2; ++j) {
+            QRegExp re(QString("(?:^|&)") + maps[j] + "=([^&]+)");
+            QVERIFY(re.indexIn(videoInfo) != -1);
+            const QString fmtUrlMap = QByteArray::fromPercentEncoding(re.cap(1).toUtf8());
+            const QByteArray name = QByteArray(payloads[i]) + ' ' + maps[j];
+            QTest::newRow(name.constData()) << fmtUrlMap << formatCounts[j];
+        }
+    }
+}
+
+void FmtUrlMapBenchmark::sameFormats_data() {
+    addPayloadRows();
+}
+
+void FmtUrlMapBenchmark::sameFormats() {
+    QFETCH(QString, fmtUrlMap);
+    QFETCH(int, formatCount);
+    const QVector<FmtUrlMap::Format> formats = FmtUrlMap::parse(fmtUrlMap);
+    const QVector<FmtUrlMap::Format> expected = splitParse(fmtUrlMap);
+    QCOMPARE(formats.size(), formatCount);
+    QCOMPARE(expected.size(), formatCount);
+    for (int i = 0; i < formatCount; ++i) {
+        QVERIFY(formats.at(i).itag > 0);
+        QVERIFY(formats.at(i).url.startsWith(QLatin1String("https://")));
+        QVERIFY(!formats.at(i).sig.isEmpty());
+        QCOMPARE(formats.at(i).itag, expected.at(i).itag);
+        QCOMPARE(formats.at(i).url, expected.at(i).url);
+        QCOMPARE(formats.at(i).sig, expected.at(i).sig);
+        QCOMPARE(formats.at(i).encrypted, expected.at(i).encrypted);
+    }
+}
+
+void FmtUrlMapBenchmark::singlePass_data() {
+    addPayloadRows();
+}
+
+void FmtUrlMapBenchmark::singlePass() {
+    QFETCH(QString, fmtUrlMap);
+    QFETCH(int, formatCount);
+    QBENCHMARK {
+        QCOMPARE(FmtUrlMap::parse(fmtUrlMap).size(), formatCount);
+    }
+}
+
+void FmtUrlMapBenchmark::split_data() {
+    addPayloadRows();
+}
+
+void FmtUrlMapBenchmark::split() {
+    QFETCH(QString, fmtUrlMap);
+    QFETCH(int, formatCount);
+    QBENCHMARK {
+        QCOMPARE(splitParse(fmtUrlMap).size(), formatCount);
+    }
+}
+
+QTEST_GUILESS_MAIN(FmtUrlMapBenchmark)
+
+#include "tst_fmturlmap.moc"
@@ -0,0 +1,8 @@
+TARGET = tst_playerdecipher
+QT += qml
+
+include(../benchmark.pri)
+
+HEADERS += $$SRC_DIR/playerdecipher.h
+SOURCES += $$SRC_DIR/playerdecipher.cpp \
+    tst_playerdecipher.cpp
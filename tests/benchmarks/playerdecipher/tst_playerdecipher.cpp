@@ -0,0 +1,121 @@
+#include <QtTest>
+
+#include "playerdecipher.h"
+
+/*
+ * Deciphering the signatures of a 30 format fmt_url_map.
+ *
+ * evaluate is what Video::decryptSignature() used to do for every format:
+ * a new QJSEngine, the player's helper object and function evaluated
+ * again, then a source string calling the function.
+ * compiled is PlayerDecipher seeing a new player: one compile, 30 calls.
+ * memoized is PlayerDecipher on a map it has already seen, as on a refresh.
+ *
+ * The functions have the shape of the ones Video captures from the player:
+ * an object of array helpers and a function chaining them.
+ */
+
+namespace {
+
+const int formatCount = 30;
+const char *playerUrl = "https://www.youtube.com/yts/jsbin/player-vflbenchmark/en_US/base.js";
+const char *functionName = "Ay";
+
+const char *helperObject =
+        "var Qx={rV:function(a){a.reverse()},"
+        "Ng:function(a,b){a.splice(0,b)},"
+        "qK:function(a,b){var c=a[0];a[0]=a[b%a.length];a[b%a.length]=c}};";
+
+const char *signatureFunction =
+        "function Ay(a){a=a.split(\"\");Qx.qK(a,46);Qx.rV(a,31);Qx.Ng(a,3);"
+        "Qx.qK(a,14);Qx.rV(a,9);Qx.Ng(a,2);Qx.qK(a,62);return a.join(\"\")}";
+
+QString legacyDecrypt(const QString &s) {
+    QJSEngine engine;
+    QJSValue value = engine.evaluate(helperObject);
+    if (value.isError()) qWarning() << "Error in" << helperObject << value.toString();
+    value = engine.evaluate(signatureFunction);
+    if (value.isError()) qWarning() << "Error in" << signatureFunction << value.toString();
+    QString js = QLatin1String(functionName) + "('" + s + "');";
+    value = engine.evaluate(js);
+    if (value.isUndefined() || value.isError()) {
+        qWarning() << "Error in" << js << value.toString();
+        return QString();
+    }
+    return value.toString();
+}
+
+}
+
+class PlayerDecipherBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void sameSignatures();
+    void evaluate();
+    void compiled();
+    void memoized();
+
+private:
+    void compile();
+
+    // 30 encrypted signatures, 87 characters like the real ones
+    QStringList signatures;
+};
+
+void PlayerDecipherBenchmark::initTestCase() {
+    const QString chars = "0123456789ABCDEF";
+    for (int i = 0; i < formatCount; ++i) {
+        QString s;
+        for (int j = 0; j < 87; ++j)
+            s += j == 40 ? QChar('.') : chars.at((i * 7 + j * 13 + i * j) % chars.size());
+        signatures << s;
+    }
+}
+
+void PlayerDecipherBenchmark::compile() {
+    PlayerDecipher::instance().compile(playerUrl, functionName,
+                                       QList<QString>() << helperObject << signatureFunction);
+}
+
+void PlayerDecipherBenchmark::sameSignatures() {
+    compile();
+    QVERIFY(PlayerDecipher::instance().isReady(playerUrl));
+    foreach (const QString &s, signatures) {
+        const QString expected = legacyDecrypt(s);
+        QVERIFY(!expected.isEmpty());
+        QVERIFY(expected != s);
+        QCOMPARE(PlayerDecipher::instance().decipher(s), expected);
+    }
+}
+
+void PlayerDecipherBenchmark::evaluate() {
+    QBENCHMARK {
+        foreach (const QString &s, signatures)
+            QVERIFY(!legacyDecrypt(s).isEmpty());
+    }
+}
+
+void PlayerDecipherBenchmark::compiled() {
+    QBENCHMARK {
+        // compiling forgets the memoized results
+        compile();
+        foreach (const QString &s, signatures)
+            QVERIFY(!PlayerDecipher::instance().decipher(s).isEmpty());
+    }
+}
+
+void PlayerDecipherBenchmark::memoized() {
+    compile();
+    foreach (const QString &s, signatures) PlayerDecipher::instance().decipher(s);
+    QBENCHMARK {
+        foreach (const QString &s, signatures)
+            QVERIFY(!PlayerDecipher::instance().decipher(s).isEmpty());
+    }
+}
+
+QTEST_GUILESS_MAIN(PlayerDecipherBenchmark)
+
+#include "tst_playerdecipher.moc"
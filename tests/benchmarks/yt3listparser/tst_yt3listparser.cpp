@@ -0,0 +1,149 @@
+#include <QtTest>
+
+#include "yt3listparser.h"
+#include "datautils.h"
+
+/*
+ * Parsing 50 item YouTube Data API v3 pages.
+ *
+ * stream is YT3ListParser, reading only the fields it keeps.
+ * document is the QJsonDocument walk YT3ListParser used before,
+ * and still uses as a fallback, copied here because it is private.
+ *
+ * The fixtures in data/ follow the shape of search.list, videos.list and
+ * playlistItems.list responses, including the fields nobody reads.
+ */
+
+namespace {
+
+QVector<VideoRecord> parseDocument(const QByteArray &bytes) {
+    QVector<VideoRecord> records;
+    QJsonDocument doc = QJsonDocument::fromJson(bytes);
+    QJsonObject obj = doc.object();
+    QJsonArray items = obj["items"].toArray();
+    records.reserve(items.size());
+    foreach (const QJsonValue &v, items) {
+        QJsonObject item = v.toObject();
+        VideoRecord video;
+
+        QJsonObject snippet = item["snippet"].toObject();
+
+        QJsonValue id = item["id"];
+        QJsonValue resourceId = snippet["resourceId"];
+        if (resourceId.isObject())
+            video.setId(resourceId.toObject()["videoId"].toString());
+        else if (id.isString()) video.setId(id.toString());
+        else video.setId(id.toObject()["videoId"].toString());
+
+        QString liveBroadcastContent = snippet["liveBroadcastContent"].toString();
+        if (!liveBroadcastContent.isEmpty() && liveBroadcastContent != QLatin1String("none"))
+            continue;
+
+        video.setPublished(QDateTime::fromString(snippet["publishedAt"].toString(), Qt::ISODate));
+        video.setChannelId(snippet["channelId"].toString());
+        video.setTitle(snippet["title"].toString());
+        video.setDescription(snippet["description"].toString());
+
+        QJsonObject thumbnails = snippet["thumbnails"].toObject();
+        video.setThumbnailUrl(thumbnails["medium"].toObject()["url"].toString());
+        video.setMediumThumbnailUrl(thumbnails["high"].toObject()["url"].toString());
+        video.setLargeThumbnailUrl(thumbnails["standard"].toObject()["url"].toString());
+
+        video.setChannelTitle(snippet["channelTitle"].toString());
+
+        QJsonValue contentDetails = item["contentDetails"];
+        if (contentDetails.isObject())
+            video.setDuration(DataUtils::parseIsoPeriod(
+                                  contentDetails.toObject()["duration"].toString()));
+
+        QJsonValue statistics = item["statistics"];
+        if (statistics.isObject())
+            video.setViewCount(statistics.toObject()["viewCount"].toString().toInt());
+
+        records.append(video);
+    }
+    return records;
+}
+
+}
+
+class YT3ListParserBenchmark : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void sameRecords_data();
+    void sameRecords();
+    void stream_data();
+    void stream();
+    void document_data();
+    void document();
+
+private:
+    void addFixtureRows();
+};
+
+void YT3ListParserBenchmark::addFixtureRows() {
+    QTest::addColumn<QByteArray>("bytes");
+    const char *fixtures[] = { "search", "videos", "playlistitems" };
+    for (int i = 0; i < 3; ++i) {
+        const QString fileName = QString("data/") + fixtures[i] + ".json";
+        QFile file(QFINDTESTDATA(fileName));
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.fileName()));
+        QTest::newRow(fixtures[i]) << file.readAll();
+    }
+}
+
+void YT3ListParserBenchmark::sameRecords_data() {
+    addFixtureRows();
+}
+
+void YT3ListParserBenchmark::sameRecords() {
+    QFETCH(QByteArray, bytes);
+    const QVector<VideoRecord> streamed = YT3ListParser(bytes).getRecords();
+    const QVector<VideoRecord> expected = parseDocument(bytes);
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(streamed.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i) {
+        const VideoRecord &a = streamed.at(i);
+        const VideoRecord &b = expected.at(i);
+        QCOMPARE(a.id(), b.id());
+        QCOMPARE(a.title(), b.title());
+        QCOMPARE(a.description(), b.description());
+        QCOMPARE(a.channelId(), b.channelId());
+        QCOMPARE(a.channelTitle(), b.channelTitle());
+        QCOMPARE(a.published(), b.published());
+        QCOMPARE(a.thumbnailUrl(), b.thumbnailUrl());
+        QCOMPARE(a.mediumThumbnailUrl(), b.mediumThumbnailUrl());
+        QCOMPARE(a.largeThumbnailUrl(), b.largeThumbnailUrl());
+        QCOMPARE(a.duration(), b.duration());
+        QCOMPARE(a.viewCount(), b.viewCount());
+    }
+}
+
+void YT3ListParserBenchmark::stream_data() {
+    addFixtureRows();
+}
+
+void YT3ListParserBenchmark::stream() {
+    QFETCH(QByteArray, bytes);
+    QBENCHMARK {
+        YT3ListParser parser(bytes);
+        QVERIFY(!parser.getRecords().isEmpty());
+    }
+}
+
+void YT3ListParserBenchmark::document_data() {
+    addFixtureRows();
+}
+
+void YT3ListParserBenchmark::document() {
+    QFETCH(QByteArray, bytes);
+    QBENCHMARK {
+        QVERIFY(!parseDocument(bytes).isEmpty());
+    }
+}
+
+QTEST_GUILESS_MAIN(YT3ListParserBenchmark)
+
+#include "tst_yt3listparser.moc"
@@ -0,0 +1,20 @@
+TARGET = tst_yt3listparser
+# yt3listparser.cpp includes video.h
+QT += widgets network
+
+include(../benchmark.pri)
+
+HEADERS += \
+    $$SRC_DIR/yt3listparser.h \
+    $$SRC_DIR/jsonparsetask.h \
+    $$SRC_DIR/jsonreader.h \
+    $$SRC_DIR/datautils.h \
+    $$SRC_DIR/videorecord.h
+
+SOURCES += \
+    $$SRC_DIR/yt3listparser.cpp \
+    $$SRC_DIR/jsonparsetask.cpp \
+    $$SRC_DIR/jsonreader.cpp \
+    $$SRC_DIR/datautils.cpp \
+    $$SRC_DIR/videorecord.cpp \
+    tst_yt3listparser.cpp
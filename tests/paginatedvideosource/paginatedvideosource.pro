@@ -0,0 +1,33 @@
+TARGET = tst_paginatedvideosource
+# video.h and videosource.h include widgets and network headers
+QT += widgets network
+
+include(../benchmarks/benchmark.pri)
+include(../benchmarks/database.pri)
+include($$SRC_DIR/http/http.pri)
+
+HEADERS += \
+    $$SRC_DIR/paginatedvideosource.h \
+    $$SRC_DIR/videosource.h \
+    $$SRC_DIR/videorecord.h \
+    $$SRC_DIR/videodetailscache.h \
+    $$SRC_DIR/pagetokencache.h \
+    $$SRC_DIR/yt3.h \
+    $$SRC_DIR/yt3listparser.h \
+    $$SRC_DIR/jsonparsetask.h \
+    $$SRC_DIR/jsonreader.h \
+    $$SRC_DIR/datautils.h \
+    $$SRC_DIR/httputils.h
+
+# yt3.cpp and httputils.cpp are replaced by the test, see there
+SOURCES += \
+    $$SRC_DIR/paginatedvideosource.cpp \
+    $$SRC_DIR/videosource.cpp \
+    $$SRC_DIR/videorecord.cpp \
+    $$SRC_DIR/videodetailscache.cpp \
+    $$SRC_DIR/pagetokencache.cpp \
+    $$SRC_DIR/yt3listparser.cpp \
+    $$SRC_DIR/jsonparsetask.cpp \
+    $$SRC_DIR/jsonreader.cpp \
+    $$SRC_DIR/datautils.cpp \
+    tst_paginatedvideosource.cpp
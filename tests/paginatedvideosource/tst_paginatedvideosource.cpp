@@ -0,0 +1,173 @@
+#include <QtTest>
+
+#include "paginatedvideosource.h"
+#include "database.h"
+#include "http.h"
+#include "httputils.h"
+#include "yt3.h"
+
+/*
+ * Details requests of PaginatedVideoSource against a fake Http.
+ *
+ * HttpUtils::yt() hands out replies the test finishes by hand,
+ * YT3 only has to build the request urls.
+ * VideoDetailsCache is the real one on an empty test database,
+ * so every video of a page is requested.
+ */
+
+namespace {
+
+class FakeReply : public HttpReply {
+
+    Q_OBJECT
+
+public:
+    FakeReply(const QUrl &url) : requestUrl(url), status(0) { }
+    QUrl url() const { return requestUrl; }
+    int statusCode() const { return status; }
+    QByteArray body() const { return QByteArray(); }
+
+    void finish(int statusCode) {
+        status = statusCode;
+        emit finished(*this);
+    }
+
+private:
+    QUrl requestUrl;
+    int status;
+};
+
+class FakeHttp : public Http {
+
+public:
+    QObject *request(const HttpRequest &req) {
+        FakeReply *reply = new FakeReply(req.url);
+        replies << reply;
+        return reply;
+    }
+
+    QList<FakeReply*> replies;
+};
+
+FakeHttp &fakeHttp() {
+    static FakeHttp http;
+    return http;
+}
+
+// loads pages of videos that only have an id
+class TestSource : public PaginatedVideoSource {
+
+public:
+    TestSource() {
+        setAsyncDetails(false);
+    }
+
+    void loadVideos(int max, int startIndex) {
+        Q_UNUSED(startIndex);
+        aborted = false;
+        QVector<VideoRecord> videos;
+        for (int i = 0; i < max; ++i) {
+            VideoRecord video;
+            video.setId("vid" + QString::number(i));
+            videos << video;
+        }
+        loadVideoDetails(videos);
+    }
+
+    const QStringList &getSuggestions() {
+        static const QStringList suggestions;
+        return suggestions;
+    }
+
+    QString getName() { return QString(); }
+
+protected:
+    void parseResults(const YT3ListParser &parser) {
+        Q_UNUSED(parser);
+    }
+};
+
+}
+
+Http &HttpUtils::yt() {
+    return fakeHttp();
+}
+
+YT3::YT3() { }
+
+YT3 &YT3::instance() {
+    static YT3 i;
+    return i;
+}
+
+QUrl YT3::method(const QString &name) {
+    return QUrl(QString("https://www.googleapis.com/youtube/v3/" + name));
+}
+
+void YT3::testResponse(const HttpReply &reply) {
+    Q_UNUSED(reply);
+}
+
+class PaginatedVideoSourceTest : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void detailsCompletePage();
+    void reloadWhileDetailsInFlight();
+};
+
+void PaginatedVideoSourceTest::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
+    Database::instance().drop();
+}
+
+void PaginatedVideoSourceTest::cleanupTestCase() {
+    Database::instance().drop();
+}
+
+void PaginatedVideoSourceTest::cleanup() {
+    qDeleteAll(fakeHttp().replies);
+    fakeHttp().replies.clear();
+}
+
+void PaginatedVideoSourceTest::detailsCompletePage() {
+    TestSource source;
+    QSignalSpy spy(&source, SIGNAL(finished(int)));
+    source.loadVideos(15, 1);
+    // chunks of 10 ids
+    QCOMPARE(fakeHttp().replies.size(), 2);
+
+    fakeHttp().replies.at(0)->finish(500);
+    QCOMPARE(spy.count(), 0);
+    fakeHttp().replies.at(1)->finish(500);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toInt(), 15);
+}
+
+void PaginatedVideoSourceTest::reloadWhileDetailsInFlight() {
+    TestSource source;
+    QSignalSpy spy(&source, SIGNAL(finished(int)));
+    source.loadVideos(5, 1);
+    QCOMPARE(fakeHttp().replies.size(), 1);
+    FakeReply *stale = fakeHttp().replies.last();
+
+    source.abort();
+    source.loadVideos(5, 1);
+    QCOMPARE(fakeHttp().replies.size(), 2);
+
+    // the reply of the first load must not complete the second one
+    stale->finish(500);
+    QCOMPARE(spy.count(), 0);
+
+    fakeHttp().replies.last()->finish(500);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toInt(), 5);
+}
+
+QTEST_GUILESS_MAIN(PaginatedVideoSourceTest)
+
+#include "tst_paginatedvideosource.moc"
@@ -0,0 +1,66 @@
+#include <QtTest>
+
+#include "database.h"
+#include "aggregatevideosource.h"
+
+/*
+ * The hot queries are served by the indexes the migrations create for them.
+ * Catches schema or query edits that fall back to a full table scan.
+ * The SQL is the one the application runs, taken from Database and
+ * AggregateVideoSource.
+ */
+
+class QueryPlansTest : public QObject {
+
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void usesIndex_data();
+    void usesIndex();
+};
+
+void QueryPlansTest::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
+    Database::instance().drop();
+}
+
+void QueryPlansTest::cleanupTestCase() {
+    Database::instance().drop();
+}
+
+void QueryPlansTest::usesIndex_data() {
+    QTest::addColumn<QString>("sql");
+    QTest::addColumn<QString>("index");
+
+    QTest::newRow("YTChannel::latestVideoId()")
+            << QString(Database::latestVideoIdSql) << QString("idx_videos_user_published");
+    QTest::newRow("SubscriptionVideos::add()")
+            << QString(Database::channelUpdatedSql) << QString("idx_videos_channel_published");
+    QTest::newRow("YTChannel::updateNotifyCount()")
+            << QString(Database::unwatchedCountSql) << QString("idx_videos_channel_watched");
+    QTest::newRow("AggregateVideoSource::loadVideos()")
+            << AggregateVideoSource::pageSql(false, true) << QString("idx_videos_published");
+    QTest::newRow("ChannelAggregator::getChannelsToCheck()")
+            << QString(Database::channelsToCheckSql) << QString("idx_checked");
+    QTest::newRow("VideoDetailsCache::prune()")
+            << QString(Database::pruneDetailsSql) << QString("idx_details_fetched");
+}
+
+void QueryPlansTest::usesIndex() {
+    QFETCH(QString, sql);
+    QFETCH(QString, index);
+
+    QSqlQuery query(Database::instance().getConnection());
+    QVERIFY2(query.exec(QString("explain query plan " + sql)), qPrintable(query.lastError().text()));
+    QString details;
+    // the detail column is the last one in every SQLite version
+    while (query.next())
+        details += query.value(query.record().count() - 1).toString() + ' ';
+    QVERIFY2(details.contains(index), qPrintable(details));
+}
+
+QTEST_GUILESS_MAIN(QueryPlansTest)
+
+#include "tst_queryplans.moc"
@@ -0,0 +1,8 @@
+# Tests and micro-benchmarks, build and run them with:
+# qmake tests/tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    benchmarks \
+    paginatedvideosource \
+    queryplans